@@ -0,0 +1,379 @@
+/*
+ * pal-ssd1306-bench.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Benchmarks for the SSD1306 drawing primitives and render paths, over a
+ * mock transport so that no display is needed. On the host, times are in
+ * nanoseconds; on the RP2040 they come from the SysTick counter, in CPU
+ * cycles. Alongside each time is the number of bytes that showing the
+ * result would put on the I2C bus (address and control bytes included),
+ * and the predicted bus time for a full frame.
+ */
+
+/* Header files. */
+
+#include <stdio.h>
+
+#include <pico/stdlib.h>
+
+#if PICO_ON_DEVICE
+#include <hardware/clocks.h>
+#include <hardware/structs/systick.h>
+#else
+#include <time.h>
+#endif
+
+#include "pal-ssd1306.h"
+#include "pal-ssd1306-timing.h"
+#include "fonts/pal-ssd1306-font-8x16.h"
+#include "fonts/pal-ssd1306-font-proportional.h"
+
+
+/* Constants. */
+
+#if PICO_ON_DEVICE
+#define BENCH_DRAW_ITERATIONS   2000
+#define BENCH_RENDER_ITERATIONS 50
+#else
+#define BENCH_DRAW_ITERATIONS   50000
+#define BENCH_RENDER_ITERATIONS 5000
+#endif
+
+
+/* Types. */
+
+typedef pal::SSD1306Driver<pal::MockTransport> bench_display_t;
+typedef void (*bench_op_t)( bench_display_t *p_display, uint32_t p_iteration );
+
+typedef struct
+{
+  const char *name;
+  bench_op_t  op;
+  bool        render;
+} bench_case_t;
+
+
+/* Functions. */
+
+/*
+ * bench_ticks; returns the current time. The SysTick counter is only 24 bits
+ *              and counts down, so on the RP2040 it can only be used to time
+ *              short intervals.
+ */
+
+#if PICO_ON_DEVICE
+
+static void bench_timer_init( void )
+{
+  systick_hw->csr = 0;
+  systick_hw->rvr = 0x00FFFFFF;
+  systick_hw->cvr = 0;
+  systick_hw->csr = 0x05;     /* Enabled, counting processor clock cycles */
+  return;
+}
+
+static inline uint32_t bench_ticks( void )
+{
+  return systick_hw->cvr;
+}
+
+static inline uint32_t bench_elapsed( uint32_t p_start, uint32_t p_end )
+{
+  return ( p_start - p_end ) & 0x00FFFFFF;
+}
+
+#else
+
+static void bench_timer_init( void )
+{
+  return;
+}
+
+static inline uint64_t bench_ticks( void )
+{
+  struct timespec l_now;
+
+  clock_gettime( CLOCK_MONOTONIC, &l_now );
+  return ( (uint64_t)l_now.tv_sec * 1000000000 ) + l_now.tv_nsec;
+}
+
+static inline uint64_t bench_elapsed( uint64_t p_start, uint64_t p_end )
+{
+  return p_end - p_start;
+}
+
+#endif
+
+
+/*
+ * bench_run; runs an operation the given number of times, returning the total
+ *            ticks taken. On the RP2040 each call is timed on its own, so the
+ *            SysTick counter never wraps; on the host, the whole loop is.
+ */
+
+static uint64_t bench_run( bench_display_t *p_display, bench_op_t p_op, uint32_t p_iterations )
+{
+  uint64_t l_total = 0;
+
+#if PICO_ON_DEVICE
+  uint32_t l_start;
+
+  for ( uint32_t l_index = 0; l_index < p_iterations; l_index++ )
+  {
+    l_start = bench_ticks();
+    p_op( p_display, l_index );
+    l_total += bench_elapsed( l_start, bench_ticks() );
+  }
+#else
+  uint64_t l_start = bench_ticks();
+
+  for ( uint32_t l_index = 0; l_index < p_iterations; l_index++ )
+  {
+    p_op( p_display, l_index );
+  }
+  l_total = bench_elapsed( l_start, bench_ticks() );
+#endif
+
+  return l_total;
+}
+
+
+/*
+ * bench_wire_bytes; returns what the transport would have put on the I2C
+ *                   bus since it was last reset: each transaction has an
+ *                   address and a control byte ahead of its payload.
+ */
+
+static size_t bench_wire_bytes( bench_display_t *p_display )
+{
+  pal::MockTransport *l_mock = p_display->get_transport();
+
+  return l_mock->bytes_sent() + ( 2 * l_mock->transactions_sent() );
+}
+
+
+/*
+ * op_*; the operations being measured.
+ */
+
+static void op_nothing( bench_display_t *p_display, uint32_t p_iteration )
+{
+  return;
+}
+
+static void op_set_pixel( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->set_pixel( ( p_iteration * 37 ) & 0x7F, ( p_iteration * 11 ) & 0x3F );
+  return;
+}
+
+static void op_hline( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->draw_line( 0, p_iteration & 0x1F, 127, p_iteration & 0x1F );
+  return;
+}
+
+static void op_vline( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->draw_line( p_iteration & 0x7F, 0, p_iteration & 0x7F, 63 );
+  return;
+}
+
+static void op_diagonal( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->draw_line( 0, 0, 127, 63 );
+  return;
+}
+
+static void op_filled_box( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->draw_box( 10, 3, 64, 24, true );
+  return;
+}
+
+static void op_draw_char( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->draw_char( ( p_iteration * 6 ) & 0x7F, 8, 'A' + ( p_iteration % 26 ) );
+  return;
+}
+
+static void op_draw_text( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->draw_text( 0, 3, "The quick brown fox j" );
+  return;
+}
+
+static void op_draw_text_cached( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->enable_glyph_cache();
+  p_display->draw_text( 0, 3, "The quick brown fox j" );
+  return;
+}
+
+static void op_draw_text_proportional( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->draw_text( 0, 3, "The quick brown fox jumps", pal::font_proportional );
+  return;
+}
+
+static void op_draw_text_8x16( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->draw_text( 0, 3, "The quick brow", pal::font_8x16 );
+  return;
+}
+
+static void op_clear( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->clear();
+  return;
+}
+
+static void op_render_full( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->get_transport()->reset();
+  p_display->mark_dirty_region( 0, 0, 128, 64 );
+  p_display->render();
+  return;
+}
+
+static void op_render_glyph( bench_display_t *p_display, uint32_t p_iteration )
+{
+  p_display->get_transport()->reset();
+  p_display->mark_dirty_region( 6, 8, 6, 8 );
+  p_display->render();
+  return;
+}
+
+
+/*
+ * bench_bus; predicts, with the bus timing model, how long a full frame
+ *            takes to send at each of the standard I2C clock rates.
+ */
+
+static void bench_bus( bench_display_t *p_display )
+{
+  static const uint32_t l_clocks[] = { 100000, 400000, 1000000 };
+
+  p_display->get_transport()->reset();
+  p_display->mark_dirty_region( 0, 0, 128, 64 );
+  p_display->render();
+
+  for ( uint32_t l_clock : l_clocks )
+  {
+    pal::I2CTimingModel l_model( l_clock );
+
+    l_model.add( p_display->get_transport() );
+    printf( "full frame at %4lu kHz: %9.1f us, %6.1f fps max, %6.1f%% of the bus at 30 fps\n",
+            (unsigned long)( l_clock / 1000 ), l_model.timing()->duration_ns / 1000.0,
+            l_model.max_fps(), l_model.utilisation( 30.0f ) * 100.0f );
+  }
+  return;
+}
+
+
+/*
+ * bench_display; runs every case against a display of the given size.
+ */
+
+static void bench_display( uint8_t p_width, uint8_t p_height )
+{
+  static const bench_case_t l_cases[] = {
+    { "set_pixel",              op_set_pixel,              false },
+    { "draw_line horizontal",   op_hline,                  false },
+    { "draw_line vertical",     op_vline,                  false },
+    { "draw_line diagonal",     op_diagonal,               false },
+    { "draw_box filled",        op_filled_box,             false },
+    { "draw_char",              op_draw_char,              false },
+    { "draw_text (21 chars)",   op_draw_text,              false },
+    { "draw_text cached",       op_draw_text_cached,       false },
+    { "draw_text proportional", op_draw_text_proportional, false },
+    { "draw_text 8x16",         op_draw_text_8x16,         false },
+    { "clear",                  op_clear,                  false },
+    { "render full frame",      op_render_full,            true },
+    { "render one glyph",       op_render_glyph,           true },
+  };
+  bench_display_t  l_display( p_width, p_height, pal::MockTransport() );
+  uint32_t         l_iterations;
+  double           l_overhead, l_ticks;
+  size_t           l_bytes;
+
+  printf( "\n%ux%u display\n", p_width, p_height );
+#if PICO_ON_DEVICE
+  printf( "%-24s %12s %12s %12s\n", "operation", "cycles/op", "ns/op", "bytes/op" );
+#else
+  printf( "%-24s %12s %12s\n", "operation", "ns/op", "bytes/op" );
+#endif
+
+  /* What the harness itself costs, per call, to be taken off every case. */
+  l_overhead = (double)bench_run( &l_display, op_nothing, BENCH_DRAW_ITERATIONS ) / BENCH_DRAW_ITERATIONS;
+
+  for ( const bench_case_t &l_case : l_cases )
+  {
+    /* Bytes on the wire: what rendering the result of one op would send. */
+    l_display.clear();
+    l_display.render();
+    l_display.get_transport()->reset();
+    l_case.op( &l_display, 1 );
+    if ( !l_case.render )
+    {
+      l_display.get_transport()->reset();
+      l_display.render();
+    }
+    l_bytes = bench_wire_bytes( &l_display );
+
+    /* And the time per op. */
+    l_display.clear();
+    l_iterations = l_case.render ? BENCH_RENDER_ITERATIONS : BENCH_DRAW_ITERATIONS;
+    l_ticks = (double)bench_run( &l_display, l_case.op, l_iterations ) / l_iterations - l_overhead;
+    if ( l_ticks < 0 )
+    {
+      l_ticks = 0;
+    }
+
+#if PICO_ON_DEVICE
+    printf( "%-24s %12.1f %12.1f %12zu\n", l_case.name, l_ticks,
+            l_ticks * 1.0e9 / clock_get_hz( clk_sys ), l_bytes );
+#else
+    printf( "%-24s %12.1f %12zu\n", l_case.name, l_ticks, l_bytes );
+#endif
+  }
+
+  bench_bus( &l_display );
+  return;
+}
+
+
+/*
+ * main; runs the benchmarks over the common panel sizes.
+ */
+
+int main( void )
+{
+  stdio_init_all();
+  bench_timer_init();
+
+#if PICO_ON_DEVICE
+  /* Give the console a chance to be connected. */
+  sleep_ms( 2000 );
+  printf( "pal-ssd1306 benchmark, clk_sys %lu Hz\n", (unsigned long)clock_get_hz( clk_sys ) );
+#else
+  printf( "pal-ssd1306 benchmark\n" );
+#endif
+
+  bench_display( 128, 64 );
+  bench_display( 128, 32 );
+  bench_display( 64, 48 );
+
+#if PICO_ON_DEVICE
+  for ( ;; )
+  {
+    tight_loop_contents();
+  }
+#endif
+  return 0;
+}
+
+
+/* End of file pal-ssd1306-bench.cpp */
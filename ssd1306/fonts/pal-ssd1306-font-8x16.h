@@ -0,0 +1,122 @@
+/*
+ * pal-ssd1306-font-8x16.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * An 8x16 font; the 8x8 font at double height, for large, easily read text.
+ * Each glyph is two pages tall.
+ */
+
+#ifndef   PAL_SSD1306_FONT_8X16_H
+#define   PAL_SSD1306_FONT_8X16_H
+
+#include "pal-ssd1306-font.h"
+
+namespace pal
+{
+  inline constexpr uint8_t font_8x16_bitmap[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // space
+    0x00, 0x00, 0x00, 0x00, 0x3C, 0x00, 0xFF, 0x33, 0xFF, 0x33, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, // !
+    0x00, 0x00, 0x0F, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, // "
+    0x30, 0x03, 0xFF, 0x3F, 0xFF, 0x3F, 0x30, 0x03, 0xFF, 0x3F, 0xFF, 0x3F, 0x30, 0x03, 0x00, 0x00, // #
+    0x30, 0x0C, 0xFC, 0x0C, 0xCF, 0x3C, 0xCF, 0x3C, 0xCC, 0x0F, 0x0C, 0x03, 0x00, 0x00, 0x00, 0x00, // $
+    0x3C, 0x30, 0x3C, 0x3C, 0x00, 0x0F, 0xC0, 0x03, 0xF0, 0x00, 0x3C, 0x3C, 0x0C, 0x3C, 0x00, 0x00, // %
+    0x00, 0x0F, 0xCC, 0x3F, 0xFF, 0x30, 0xF3, 0x33, 0x3F, 0x0F, 0xCC, 0x3F, 0xC0, 0x30, 0x00, 0x00, // &
+    0x30, 0x00, 0x3F, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // '
+    0x00, 0x00, 0xF0, 0x03, 0xFC, 0x0F, 0x0F, 0x3C, 0x03, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // (
+    0x00, 0x00, 0x03, 0x30, 0x0F, 0x3C, 0xFC, 0x0F, 0xF0, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // )
+    0xC0, 0x00, 0xCC, 0x0C, 0xFC, 0x0F, 0xF0, 0x03, 0xF0, 0x03, 0xFC, 0x0F, 0xCC, 0x0C, 0xC0, 0x00, // *
+    0xC0, 0x00, 0xC0, 0x00, 0xFC, 0x0F, 0xFC, 0x0F, 0xC0, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, // +
+    0x00, 0x00, 0x00, 0xC0, 0x00, 0xFC, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ,
+    0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, // -
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // .
+    0x00, 0x3C, 0x00, 0x0F, 0xC0, 0x03, 0xF0, 0x00, 0x3C, 0x00, 0x0F, 0x00, 0x03, 0x00, 0x00, 0x00, // /
+    0xFC, 0x0F, 0xFF, 0x3F, 0x03, 0x3F, 0xC3, 0x33, 0xF3, 0x30, 0xFF, 0x3F, 0xFC, 0x0F, 0x00, 0x00, // 0
+    0x00, 0x30, 0x0C, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x30, 0x00, 0x30, 0x00, 0x00, 0x00, 0x00, // 1
+    0x0C, 0x3C, 0x0F, 0x3F, 0xC3, 0x33, 0xC3, 0x30, 0xFF, 0x3C, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, // 2
+    0x0C, 0x0C, 0x0F, 0x3C, 0xC3, 0x30, 0xC3, 0x30, 0xFF, 0x3F, 0x3C, 0x0F, 0x00, 0x00, 0x00, 0x00, // 3
+    0xC0, 0x03, 0xF0, 0x03, 0x3C, 0x03, 0x0F, 0x33, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x33, 0x00, 0x00, // 4
+    0x3F, 0x0C, 0x3F, 0x3C, 0x33, 0x30, 0x33, 0x30, 0xF3, 0x3F, 0xC3, 0x0F, 0x00, 0x00, 0x00, 0x00, // 5
+    0xF0, 0x0F, 0xFC, 0x3F, 0xCF, 0x30, 0xC3, 0x30, 0xC3, 0x3F, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00, // 6
+    0x0F, 0x00, 0x0F, 0x00, 0x03, 0x3F, 0xC3, 0x3F, 0xFF, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, // 7
+    0x3C, 0x0F, 0xFF, 0x3F, 0xC3, 0x30, 0xC3, 0x30, 0xFF, 0x3F, 0x3C, 0x0F, 0x00, 0x00, 0x00, 0x00, // 8
+    0x3C, 0x00, 0xFF, 0x30, 0xC3, 0x30, 0xC3, 0x3C, 0xFF, 0x0F, 0xFC, 0x03, 0x00, 0x00, 0x00, 0x00, // 9
+    0x00, 0x00, 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // :
+    0x00, 0x00, 0x00, 0xC0, 0x3C, 0xFC, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ;
+    0xC0, 0x00, 0xF0, 0x03, 0x3C, 0x0F, 0x0F, 0x3C, 0x03, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // <
+    0x30, 0x0C, 0x30, 0x0C, 0x30, 0x0C, 0x30, 0x0C, 0x30, 0x0C, 0x30, 0x0C, 0x00, 0x00, 0x00, 0x00, // =
+    0x00, 0x00, 0x03, 0x30, 0x0F, 0x3C, 0x3C, 0x0F, 0xF0, 0x03, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, // >
+    0x0C, 0x00, 0x0F, 0x00, 0x03, 0x33, 0xC3, 0x33, 0xFF, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, // ?
+    0xFC, 0x0F, 0xFF, 0x3F, 0x03, 0x30, 0xF3, 0x33, 0xF3, 0x33, 0xFF, 0x03, 0xFC, 0x03, 0x00, 0x00, // @
+    0xF0, 0x3F, 0xFC, 0x3F, 0x0F, 0x03, 0x0F, 0x03, 0xFC, 0x3F, 0xF0, 0x3F, 0x00, 0x00, 0x00, 0x00, // A
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0xC3, 0x30, 0xC3, 0x30, 0xFF, 0x3F, 0x3C, 0x0F, 0x00, 0x00, // B
+    0xF0, 0x03, 0xFC, 0x0F, 0x0F, 0x3C, 0x03, 0x30, 0x03, 0x30, 0x0F, 0x3C, 0x0C, 0x0C, 0x00, 0x00, // C
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x03, 0x30, 0x0F, 0x3C, 0xFC, 0x0F, 0xF0, 0x03, 0x00, 0x00, // D
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0xC3, 0x30, 0xF3, 0x33, 0x03, 0x30, 0x0F, 0x3C, 0x00, 0x00, // E
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0xC3, 0x30, 0xF3, 0x03, 0x03, 0x00, 0x0F, 0x00, 0x00, 0x00, // F
+    0xF0, 0x03, 0xFC, 0x0F, 0x0F, 0x3C, 0x03, 0x30, 0x03, 0x33, 0x0F, 0x3F, 0x0C, 0x3F, 0x00, 0x00, // G
+    0xFF, 0x3F, 0xFF, 0x3F, 0xC0, 0x00, 0xC0, 0x00, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x00, 0x00, 0x00, // H
+    0x00, 0x00, 0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x03, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // I
+    0x00, 0x0F, 0x00, 0x3F, 0x00, 0x30, 0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x0F, 0x03, 0x00, 0x00, 0x00, // J
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0xC0, 0x00, 0xF0, 0x03, 0x3F, 0x3F, 0x0F, 0x3C, 0x00, 0x00, // K
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x03, 0x30, 0x00, 0x30, 0x00, 0x3C, 0x00, 0x3F, 0x00, 0x00, // L
+    0xFF, 0x3F, 0xFF, 0x3F, 0xFC, 0x00, 0xF0, 0x03, 0xFC, 0x00, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x00, // M
+    0xFF, 0x3F, 0xFF, 0x3F, 0x3C, 0x00, 0xF0, 0x00, 0xC0, 0x03, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x00, // N
+    0xF0, 0x03, 0xFC, 0x0F, 0x0F, 0x3C, 0x03, 0x30, 0x0F, 0x3C, 0xFC, 0x0F, 0xF0, 0x03, 0x00, 0x00, // O
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0xC3, 0x30, 0xC3, 0x00, 0xFF, 0x00, 0x3C, 0x00, 0x00, 0x00, // P
+    0xFC, 0x03, 0xFF, 0x0F, 0x03, 0x0C, 0x03, 0x3F, 0xFF, 0x3F, 0xFC, 0x33, 0x00, 0x00, 0x00, 0x00, // Q
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0xC3, 0x00, 0xC3, 0x03, 0xFF, 0x3F, 0x3C, 0x3C, 0x00, 0x00, // R
+    0x3C, 0x0C, 0xFF, 0x3C, 0xF3, 0x30, 0xC3, 0x33, 0x0F, 0x3F, 0x0C, 0x0F, 0x00, 0x00, 0x00, 0x00, // S
+    0x0F, 0x00, 0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x03, 0x30, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, // T
+    0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x30, 0x00, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x00, 0x00, 0x00, // U
+    0xFF, 0x03, 0xFF, 0x0F, 0x00, 0x3C, 0x00, 0x3C, 0xFF, 0x0F, 0xFF, 0x03, 0x00, 0x00, 0x00, 0x00, // V
+    0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x0F, 0xC0, 0x03, 0x00, 0x0F, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x00, // W
+    0x0F, 0x30, 0x3F, 0x3C, 0xF0, 0x0F, 0xC0, 0x03, 0xF0, 0x0F, 0x3F, 0x3C, 0x0F, 0x30, 0x00, 0x00, // X
+    0x3F, 0x00, 0xFF, 0x30, 0xC0, 0x3F, 0xC0, 0x3F, 0xFF, 0x30, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, // Y
+    0x3F, 0x30, 0x0F, 0x3C, 0x03, 0x3F, 0xC3, 0x33, 0xF3, 0x30, 0x3F, 0x3C, 0x0F, 0x3F, 0x00, 0x00, // Z
+    0x00, 0x00, 0xFF, 0x3F, 0xFF, 0x3F, 0x03, 0x30, 0x03, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // [
+    0x03, 0x00, 0x0F, 0x00, 0x3C, 0x00, 0xF0, 0x00, 0xC0, 0x03, 0x00, 0x0F, 0x00, 0x3C, 0x00, 0x00, // backslash
+    0x00, 0x00, 0x03, 0x30, 0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ]
+    0xC0, 0x00, 0xF0, 0x00, 0x3C, 0x00, 0x0F, 0x00, 0x3C, 0x00, 0xF0, 0x00, 0xC0, 0x00, 0x00, 0x00, // ^
+    0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, 0x00, 0xC0, // _
+    0x00, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x3F, 0x00, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // `
+    0x00, 0x0C, 0x30, 0x3F, 0x30, 0x33, 0x30, 0x33, 0xF0, 0x0F, 0xC0, 0x3F, 0x00, 0x30, 0x00, 0x00, // a
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x0F, 0xC0, 0x30, 0xC0, 0x30, 0xC0, 0x3F, 0x00, 0x0F, 0x00, 0x00, // b
+    0xC0, 0x0F, 0xF0, 0x3F, 0x30, 0x30, 0x30, 0x30, 0xF0, 0x3C, 0xC0, 0x0C, 0x00, 0x00, 0x00, 0x00, // c
+    0x00, 0x0F, 0xC0, 0x3F, 0xC0, 0x30, 0xC3, 0x30, 0xFF, 0x0F, 0xFF, 0x3F, 0x00, 0x30, 0x00, 0x00, // d
+    0xC0, 0x0F, 0xF0, 0x3F, 0x30, 0x33, 0x30, 0x33, 0xF0, 0x33, 0xC0, 0x03, 0x00, 0x00, 0x00, 0x00, // e
+    0xC0, 0x30, 0xFC, 0x3F, 0xFF, 0x3F, 0xC3, 0x30, 0x0F, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, // f
+    0xC0, 0xC3, 0xF0, 0xCF, 0x30, 0xCC, 0x30, 0xCC, 0xC0, 0xFF, 0xF0, 0x3F, 0x30, 0x00, 0x00, 0x00, // g
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0xC0, 0x00, 0x30, 0x00, 0xF0, 0x3F, 0xC0, 0x3F, 0x00, 0x00, // h
+    0x00, 0x00, 0x30, 0x30, 0xF3, 0x3F, 0xF3, 0x3F, 0x00, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // i
+    0x00, 0x3C, 0x00, 0xFC, 0x00, 0xC0, 0x00, 0xC0, 0xF3, 0xFF, 0xF3, 0x3F, 0x00, 0x00, 0x00, 0x00, // j
+    0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x03, 0xC0, 0x0F, 0xF0, 0x3C, 0x30, 0x30, 0x00, 0x00, // k
+    0x00, 0x00, 0x03, 0x30, 0xFF, 0x3F, 0xFF, 0x3F, 0x00, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // l
+    0xF0, 0x3F, 0xF0, 0x3F, 0xC0, 0x03, 0xC0, 0x0F, 0xF0, 0x03, 0xF0, 0x3F, 0xC0, 0x3F, 0x00, 0x00, // m
+    0xF0, 0x3F, 0xF0, 0x3F, 0x30, 0x00, 0x30, 0x00, 0xF0, 0x3F, 0xC0, 0x3F, 0x00, 0x00, 0x00, 0x00, // n
+    0xC0, 0x0F, 0xF0, 0x3F, 0x30, 0x30, 0x30, 0x30, 0xF0, 0x3F, 0xC0, 0x0F, 0x00, 0x00, 0x00, 0x00, // o
+    0x30, 0xC0, 0xF0, 0xFF, 0xC0, 0xFF, 0x30, 0xCC, 0x30, 0x0C, 0xF0, 0x0F, 0xC0, 0x03, 0x00, 0x00, // p
+    0xC0, 0x03, 0xF0, 0x0F, 0x30, 0x0C, 0x30, 0xCC, 0xC0, 0xFF, 0xF0, 0xFF, 0x30, 0xC0, 0x00, 0x00, // q
+    0x30, 0x30, 0xF0, 0x3F, 0xC0, 0x3F, 0xF0, 0x30, 0x30, 0x00, 0xF0, 0x03, 0xC0, 0x03, 0x00, 0x00, // r
+    0xC0, 0x30, 0xF0, 0x33, 0x30, 0x33, 0x30, 0x33, 0x30, 0x3F, 0x30, 0x0C, 0x00, 0x00, 0x00, 0x00, // s
+    0x00, 0x00, 0x30, 0x00, 0xFC, 0x0F, 0xFF, 0x3F, 0x30, 0x30, 0x30, 0x0C, 0x00, 0x00, 0x00, 0x00, // t
+    0xF0, 0x0F, 0xF0, 0x3F, 0x00, 0x30, 0x00, 0x30, 0xF0, 0x0F, 0xF0, 0x3F, 0x00, 0x30, 0x00, 0x00, // u
+    0xF0, 0x03, 0xF0, 0x0F, 0x00, 0x3C, 0x00, 0x3C, 0xF0, 0x0F, 0xF0, 0x03, 0x00, 0x00, 0x00, 0x00, // v
+    0xF0, 0x0F, 0xF0, 0x3F, 0x00, 0x3F, 0xC0, 0x0F, 0x00, 0x3F, 0xF0, 0x3F, 0xF0, 0x0F, 0x00, 0x00, // w
+    0x30, 0x30, 0xF0, 0x3C, 0xC0, 0x0F, 0x00, 0x03, 0xC0, 0x0F, 0xF0, 0x3C, 0x30, 0x30, 0x00, 0x00, // x
+    0xF0, 0xC3, 0xF0, 0xCF, 0x00, 0xCC, 0x00, 0xCC, 0xF0, 0xFF, 0xF0, 0x3F, 0x00, 0x00, 0x00, 0x00, // y
+    0xF0, 0x30, 0x30, 0x3C, 0x30, 0x3F, 0xF0, 0x33, 0xF0, 0x30, 0x30, 0x3C, 0x00, 0x00, 0x00, 0x00, // z
+    0xC0, 0x00, 0xC0, 0x00, 0xFC, 0x0F, 0x3F, 0x3F, 0x03, 0x30, 0x03, 0x30, 0x00, 0x00, 0x00, 0x00, // {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // |
+    0x03, 0x30, 0x03, 0x30, 0x3F, 0x3F, 0xFC, 0x0F, 0xC0, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, // }
+    0x0C, 0x00, 0x0F, 0x00, 0x03, 0x00, 0x0F, 0x00, 0x0C, 0x00, 0x0F, 0x00, 0x03, 0x00, 0x00, 0x00, // ~
+    0x00, 0x00, 0xFC, 0x3F, 0x0C, 0x30, 0x0C, 0x30, 0x0C, 0x30, 0x0C, 0x30, 0xFC, 0x3F, 0x00, 0x00  // undef
+  };
+
+  inline constexpr Font font_8x16 = { 16, 0x20, 0x7F, 0x7F, 8, 8, nullptr, font_8x16_bitmap, 0 };
+}
+
+#endif /* PAL_SSD1306_FONT_8X16_H */
+
+/* End of file pal-ssd1306-font-8x16.h */
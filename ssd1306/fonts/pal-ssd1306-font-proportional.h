@@ -0,0 +1,222 @@
+/*
+ * pal-ssd1306-font-proportional.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A proportional font, seven pixels tall with descenders on an eighth row;
+ * narrow glyphs take up less room, so a line holds about a third more text
+ * than with the 5x7 font.
+ */
+
+#ifndef   PAL_SSD1306_FONT_PROPORTIONAL_H
+#define   PAL_SSD1306_FONT_PROPORTIONAL_H
+
+#include "pal-ssd1306-font.h"
+
+namespace pal
+{
+  inline constexpr uint8_t font_proportional_bitmap[] = {
+    // space
+    0x5F, // !
+    0x03, 0x00, 0x03, // "
+    0x14, 0x7F, 0x14, 0x7F, 0x14, // #
+    0x24, 0x2A, 0x7F, 0x2A, 0x12, // $
+    0x23, 0x13, 0x08, 0x64, 0x62, // %
+    0x36, 0x49, 0x56, 0x20, 0x50, // &
+    0x03, // '
+    0x3E, 0x41, // (
+    0x41, 0x3E, // )
+    0x2A, 0x1C, 0x2A, // *
+    0x08, 0x1C, 0x08, // +
+    0x80, 0x60, // ,
+    0x08, 0x08, 0x08, // -
+    0x40, // .
+    0x60, 0x1C, 0x03, // /
+    0x3E, 0x49, 0x45, 0x3E, // 0
+    0x42, 0x7F, 0x40, // 1
+    0x62, 0x51, 0x49, 0x46, // 2
+    0x41, 0x49, 0x49, 0x36, // 3
+    0x1C, 0x12, 0x7F, 0x10, // 4
+    0x27, 0x45, 0x45, 0x39, // 5
+    0x3E, 0x49, 0x49, 0x30, // 6
+    0x01, 0x71, 0x0D, 0x03, // 7
+    0x36, 0x49, 0x49, 0x36, // 8
+    0x06, 0x49, 0x49, 0x3E, // 9
+    0x24, // :
+    0x80, 0x64, // ;
+    0x08, 0x14, 0x22, // <
+    0x14, 0x14, 0x14, // =
+    0x22, 0x14, 0x08, // >
+    0x02, 0x51, 0x09, 0x06, // ?
+    0x3E, 0x41, 0x5D, 0x55, 0x1E, // @
+    0x7E, 0x09, 0x09, 0x7E, // A
+    0x7F, 0x49, 0x49, 0x36, // B
+    0x3E, 0x41, 0x41, 0x22, // C
+    0x7F, 0x41, 0x41, 0x3E, // D
+    0x7F, 0x49, 0x49, 0x41, // E
+    0x7F, 0x09, 0x09, 0x01, // F
+    0x3E, 0x41, 0x49, 0x7A, // G
+    0x7F, 0x08, 0x08, 0x7F, // H
+    0x41, 0x7F, 0x41, // I
+    0x20, 0x40, 0x41, 0x3F, // J
+    0x7F, 0x08, 0x14, 0x63, // K
+    0x7F, 0x40, 0x40, 0x40, // L
+    0x7F, 0x02, 0x0C, 0x02, 0x7F, // M
+    0x7F, 0x06, 0x18, 0x7F, // N
+    0x3E, 0x41, 0x41, 0x3E, // O
+    0x7F, 0x09, 0x09, 0x06, // P
+    0x3E, 0x41, 0x21, 0x5E, // Q
+    0x7F, 0x09, 0x19, 0x66, // R
+    0x46, 0x49, 0x49, 0x31, // S
+    0x01, 0x01, 0x7F, 0x01, 0x01, // T
+    0x3F, 0x40, 0x40, 0x3F, // U
+    0x0F, 0x30, 0x40, 0x30, 0x0F, // V
+    0x7F, 0x20, 0x18, 0x20, 0x7F, // W
+    0x63, 0x14, 0x08, 0x14, 0x63, // X
+    0x03, 0x04, 0x78, 0x04, 0x03, // Y
+    0x71, 0x49, 0x45, 0x43, // Z
+    0x7F, 0x41, // [
+    0x03, 0x1C, 0x60, // backslash
+    0x41, 0x7F, // ]
+    0x02, 0x01, 0x02, // ^
+    0x80, 0x80, 0x80, 0x80, // _
+    0x01, 0x02, // `
+    0x20, 0x54, 0x54, 0x78, // a
+    0x7F, 0x44, 0x44, 0x38, // b
+    0x38, 0x44, 0x44, // c
+    0x38, 0x44, 0x44, 0x7F, // d
+    0x38, 0x54, 0x54, 0x18, // e
+    0x7E, 0x05, 0x05, // f
+    0x18, 0xA4, 0xA4, 0x7C, // g
+    0x7F, 0x04, 0x04, 0x78, // h
+    0x7D, // i
+    0x80, 0x7D, // j
+    0x7F, 0x10, 0x6C, // k
+    0x7F, // l
+    0x7C, 0x04, 0x78, 0x04, 0x78, // m
+    0x7C, 0x04, 0x04, 0x78, // n
+    0x38, 0x44, 0x44, 0x38, // o
+    0xFC, 0x24, 0x24, 0x18, // p
+    0x18, 0x24, 0x24, 0xFC, // q
+    0x7C, 0x08, 0x04, // r
+    0x48, 0x54, 0x24, // s
+    0x04, 0x3F, 0x44, // t
+    0x3C, 0x40, 0x40, 0x7C, // u
+    0x3C, 0x40, 0x3C, // v
+    0x3C, 0x40, 0x30, 0x40, 0x3C, // w
+    0x6C, 0x10, 0x6C, // x
+    0x1C, 0xA0, 0xA0, 0x7C, // y
+    0x64, 0x54, 0x4C, // z
+    0x08, 0x36, 0x41, // {
+    0x7F, // |
+    0x41, 0x36, 0x08, // }
+    0x10, 0x08, 0x10, 0x08, // ~
+    0x7F, 0x41, 0x41, 0x7F  // undef
+  };
+
+  inline constexpr ssd1306_glyph_t font_proportional_glyphs[] = {
+    {    0, 0, 3 }, // space
+    {    0, 1, 2 }, // !
+    {    1, 3, 4 }, // "
+    {    4, 5, 6 }, // #
+    {    9, 5, 6 }, // $
+    {   14, 5, 6 }, // %
+    {   19, 5, 6 }, // &
+    {   24, 1, 2 }, // '
+    {   25, 2, 3 }, // (
+    {   27, 2, 3 }, // )
+    {   29, 3, 4 }, // *
+    {   32, 3, 4 }, // +
+    {   35, 2, 3 }, // ,
+    {   37, 3, 4 }, // -
+    {   40, 1, 2 }, // .
+    {   41, 3, 4 }, // /
+    {   44, 4, 5 }, // 0
+    {   48, 3, 4 }, // 1
+    {   51, 4, 5 }, // 2
+    {   55, 4, 5 }, // 3
+    {   59, 4, 5 }, // 4
+    {   63, 4, 5 }, // 5
+    {   67, 4, 5 }, // 6
+    {   71, 4, 5 }, // 7
+    {   75, 4, 5 }, // 8
+    {   79, 4, 5 }, // 9
+    {   83, 1, 2 }, // :
+    {   84, 2, 3 }, // ;
+    {   86, 3, 4 }, // <
+    {   89, 3, 4 }, // =
+    {   92, 3, 4 }, // >
+    {   95, 4, 5 }, // ?
+    {   99, 5, 6 }, // @
+    {  104, 4, 5 }, // A
+    {  108, 4, 5 }, // B
+    {  112, 4, 5 }, // C
+    {  116, 4, 5 }, // D
+    {  120, 4, 5 }, // E
+    {  124, 4, 5 }, // F
+    {  128, 4, 5 }, // G
+    {  132, 4, 5 }, // H
+    {  136, 3, 4 }, // I
+    {  139, 4, 5 }, // J
+    {  143, 4, 5 }, // K
+    {  147, 4, 5 }, // L
+    {  151, 5, 6 }, // M
+    {  156, 4, 5 }, // N
+    {  160, 4, 5 }, // O
+    {  164, 4, 5 }, // P
+    {  168, 4, 5 }, // Q
+    {  172, 4, 5 }, // R
+    {  176, 4, 5 }, // S
+    {  180, 5, 6 }, // T
+    {  185, 4, 5 }, // U
+    {  189, 5, 6 }, // V
+    {  194, 5, 6 }, // W
+    {  199, 5, 6 }, // X
+    {  204, 5, 6 }, // Y
+    {  209, 4, 5 }, // Z
+    {  213, 2, 3 }, // [
+    {  215, 3, 4 }, // backslash
+    {  218, 2, 3 }, // ]
+    {  220, 3, 4 }, // ^
+    {  223, 4, 5 }, // _
+    {  227, 2, 3 }, // `
+    {  229, 4, 5 }, // a
+    {  233, 4, 5 }, // b
+    {  237, 3, 4 }, // c
+    {  240, 4, 5 }, // d
+    {  244, 4, 5 }, // e
+    {  248, 3, 4 }, // f
+    {  251, 4, 5 }, // g
+    {  255, 4, 5 }, // h
+    {  259, 1, 2 }, // i
+    {  260, 2, 3 }, // j
+    {  262, 3, 4 }, // k
+    {  265, 1, 2 }, // l
+    {  266, 5, 6 }, // m
+    {  271, 4, 5 }, // n
+    {  275, 4, 5 }, // o
+    {  279, 4, 5 }, // p
+    {  283, 4, 5 }, // q
+    {  287, 3, 4 }, // r
+    {  290, 3, 4 }, // s
+    {  293, 3, 4 }, // t
+    {  296, 4, 5 }, // u
+    {  300, 3, 4 }, // v
+    {  303, 5, 6 }, // w
+    {  308, 3, 4 }, // x
+    {  311, 4, 5 }, // y
+    {  315, 3, 4 }, // z
+    {  318, 3, 4 }, // {
+    {  321, 1, 2 }, // |
+    {  322, 3, 4 }, // }
+    {  325, 4, 5 }, // ~
+    {  329, 4, 5 }  // undef
+  };
+
+  inline constexpr Font font_proportional = { 8, 0x20, 0x7F, 0x7F, 0, 0, font_proportional_glyphs, font_proportional_bitmap, 0 };
+}
+
+#endif /* PAL_SSD1306_FONT_PROPORTIONAL_H */
+
+/* End of file pal-ssd1306-font-proportional.h */
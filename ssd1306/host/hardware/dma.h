@@ -0,0 +1,48 @@
+/*
+ * hardware/dma.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A host stand-in for the Pico SDK header of the same name; there are no
+ * DMA channels to claim, so asynchronous rendering always falls back to
+ * blocking writes - unless a test switches on the mock (see pico-host.h).
+ */
+
+#ifndef   PAL_HOST_HARDWARE_DMA_H
+#define   PAL_HOST_HARDWARE_DMA_H
+
+#include <pico/stdlib.h>
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size
+{
+  DMA_SIZE_8 = 0,
+  DMA_SIZE_16 = 1,
+  DMA_SIZE_32 = 2
+};
+
+typedef struct
+{
+  uint32_t ctrl;
+} dma_channel_config;
+
+int                dma_claim_unused_channel( bool p_required );
+void               dma_channel_claim( uint p_channel );
+void               dma_channel_unclaim( uint p_channel );
+dma_channel_config dma_channel_get_default_config( uint p_channel );
+void               channel_config_set_transfer_data_size( dma_channel_config *p_config, enum dma_channel_transfer_size p_size );
+void               channel_config_set_read_increment( dma_channel_config *p_config, bool p_increment );
+void               channel_config_set_write_increment( dma_channel_config *p_config, bool p_increment );
+void               channel_config_set_dreq( dma_channel_config *p_config, uint p_dreq );
+void               dma_channel_configure( uint p_channel, const dma_channel_config *p_config, volatile void *p_write,
+                                          const volatile void *p_read, uint p_count, bool p_trigger );
+void               dma_channel_abort( uint p_channel );
+void               dma_channel_set_irq0_enabled( uint p_channel, bool p_enabled );
+bool               dma_channel_get_irq0_status( uint p_channel );
+void               dma_channel_acknowledge_irq0( uint p_channel );
+
+#endif /* PAL_HOST_HARDWARE_DMA_H */
+
+/* End of file hardware/dma.h */
@@ -0,0 +1,25 @@
+/*
+ * hardware/gpio.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A host stand-in for the Pico SDK header of the same name; there are no
+ * pins, so these do nothing.
+ */
+
+#ifndef   PAL_HOST_HARDWARE_GPIO_H
+#define   PAL_HOST_HARDWARE_GPIO_H
+
+#include <pico/stdlib.h>
+
+#define GPIO_IN  false
+#define GPIO_OUT true
+
+void gpio_init( uint p_gpio );
+void gpio_set_dir( uint p_gpio, bool p_out );
+void gpio_put( uint p_gpio, bool p_value );
+
+#endif /* PAL_HOST_HARDWARE_GPIO_H */
+
+/* End of file hardware/gpio.h */
@@ -0,0 +1,65 @@
+/*
+ * hardware/i2c.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A host stand-in for the Pico SDK header of the same name. There's no I2C
+ * hardware behind it, so writes fail; on Linux, use LinuxI2CTransport.
+ */
+
+#ifndef   PAL_HOST_HARDWARE_I2C_H
+#define   PAL_HOST_HARDWARE_I2C_H
+
+#include <pico/stdlib.h>
+
+#define I2C_IC_DATA_CMD_STOP_BITS        0x00000200
+#define I2C_IC_DATA_CMD_RESTART_BITS     0x00000400
+#define I2C_IC_INTR_STAT_R_TX_ABRT_BITS  0x00000040
+#define I2C_IC_INTR_STAT_R_STOP_DET_BITS 0x00000200
+#define I2C_IC_INTR_MASK_M_TX_ABRT_BITS  0x00000040
+#define I2C_IC_INTR_MASK_M_STOP_DET_BITS 0x00000200
+
+/* Just the registers the driver touches. */
+typedef struct
+{
+  volatile uint32_t enable;
+  volatile uint32_t tar;
+  volatile uint32_t data_cmd;
+  volatile uint32_t intr_stat;
+  volatile uint32_t intr_mask;
+  volatile uint32_t clr_tx_abrt;
+  volatile uint32_t clr_stop_det;
+} i2c_hw_t;
+
+typedef struct i2c_inst
+{
+  i2c_hw_t *hw;
+} i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+
+#define i2c0 ( &i2c0_inst )
+#define i2c1 ( &i2c1_inst )
+
+int i2c_write_blocking( i2c_inst_t *p_i2c, uint8_t p_address, const uint8_t *p_src, size_t p_length, bool p_nostop );
+
+static inline uint i2c_hw_index( i2c_inst_t *p_i2c )
+{
+  return ( p_i2c == i2c1 ) ? 1 : 0;
+}
+
+static inline i2c_hw_t *i2c_get_hw( i2c_inst_t *p_i2c )
+{
+  return p_i2c->hw;
+}
+
+static inline uint i2c_get_dreq( i2c_inst_t *p_i2c, bool p_is_tx )
+{
+  return 32 + ( 2 * i2c_hw_index( p_i2c ) ) + ( p_is_tx ? 0 : 1 );
+}
+
+#endif /* PAL_HOST_HARDWARE_I2C_H */
+
+/* End of file hardware/i2c.h */
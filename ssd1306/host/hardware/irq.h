@@ -0,0 +1,32 @@
+/*
+ * hardware/irq.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A host stand-in for the Pico SDK header of the same name; handlers are
+ * recorded, but nothing ever raises an interrupt (except a test, through
+ * host_irq_raise in pico-host.h).
+ */
+
+#ifndef   PAL_HOST_HARDWARE_IRQ_H
+#define   PAL_HOST_HARDWARE_IRQ_H
+
+#include <pico/stdlib.h>
+
+#define DMA_IRQ_0 11
+#define I2C0_IRQ  23
+#define I2C1_IRQ  24
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+typedef void (*irq_handler_t)( void );
+
+void          irq_set_exclusive_handler( uint p_num, irq_handler_t p_handler );
+irq_handler_t irq_get_exclusive_handler( uint p_num );
+void          irq_add_shared_handler( uint p_num, irq_handler_t p_handler, uint8_t p_priority );
+void          irq_set_enabled( uint p_num, bool p_enabled );
+
+#endif /* PAL_HOST_HARDWARE_IRQ_H */
+
+/* End of file hardware/irq.h */
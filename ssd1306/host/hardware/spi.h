@@ -0,0 +1,62 @@
+/*
+ * hardware/spi.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A host stand-in for the Pico SDK header of the same name. There's no SPI
+ * hardware behind it, so writes fail.
+ */
+
+#ifndef   PAL_HOST_HARDWARE_SPI_H
+#define   PAL_HOST_HARDWARE_SPI_H
+
+#include <pico/stdlib.h>
+
+#define SPI_SSPSR_BSY_BITS    0x00000010
+#define SPI_SSPICR_RORIC_BITS 0x00000001
+
+/* Just the registers the driver touches. */
+typedef struct
+{
+  volatile uint32_t dr;
+  volatile uint32_t sr;
+  volatile uint32_t icr;
+} spi_hw_t;
+
+typedef struct spi_inst
+{
+  spi_hw_t *hw;
+} spi_inst_t;
+
+extern spi_inst_t spi0_inst;
+extern spi_inst_t spi1_inst;
+
+#define spi0 ( &spi0_inst )
+#define spi1 ( &spi1_inst )
+
+int spi_write_blocking( spi_inst_t *p_spi, const uint8_t *p_src, size_t p_length );
+
+static inline uint spi_get_index( spi_inst_t *p_spi )
+{
+  return ( p_spi == spi1 ) ? 1 : 0;
+}
+
+static inline spi_hw_t *spi_get_hw( spi_inst_t *p_spi )
+{
+  return p_spi->hw;
+}
+
+static inline uint spi_get_dreq( spi_inst_t *p_spi, bool p_is_tx )
+{
+  return 16 + ( 2 * spi_get_index( p_spi ) ) + ( p_is_tx ? 0 : 1 );
+}
+
+static inline bool spi_is_readable( spi_inst_t *p_spi )
+{
+  return false;
+}
+
+#endif /* PAL_HOST_HARDWARE_SPI_H */
+
+/* End of file hardware/spi.h */
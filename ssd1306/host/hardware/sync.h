@@ -0,0 +1,24 @@
+/*
+ * hardware/sync.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A host stand-in for the Pico SDK header of the same name.
+ */
+
+#ifndef   PAL_HOST_HARDWARE_SYNC_H
+#define   PAL_HOST_HARDWARE_SYNC_H
+
+#include <atomic>
+
+#include <pico/stdlib.h>
+
+static inline void __dmb( void )
+{
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+}
+
+#endif /* PAL_HOST_HARDWARE_SYNC_H */
+
+/* End of file hardware/sync.h */
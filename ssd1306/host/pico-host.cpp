@@ -0,0 +1,467 @@
+/*
+ * pico-host.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Host stand-ins for the handful of Pico SDK functions that pal-ssd1306
+ * uses, so that the driver builds and runs off the Pico. There is no
+ * hardware behind any of it; I2C and SPI writes fail, DMA channels can't
+ * be claimed and interrupts never happen. Display traffic on a host goes
+ * through a host transport instead (LinuxI2CTransport, for example).
+ *
+ * Tests can change that, through the hooks in pico-host.h; they can take
+ * the I2C writes, and mock the DMA channels and the interrupts that signal
+ * the end of a transfer.
+ */
+
+/* Header files. */
+
+#include <time.h>
+
+#include <pico/stdlib.h>
+#include <pico/multicore.h>
+#include <hardware/i2c.h>
+#include <hardware/spi.h>
+#include <hardware/dma.h>
+#include <hardware/irq.h>
+#include <hardware/gpio.h>
+
+#include "pico-host.h"
+
+
+/* Constants. */
+
+#define HOST_IRQ_COUNT  32
+#define HOST_IRQ_SHARED 4
+#define HOST_FIFO_DEPTH 8
+
+
+/* Globals. */
+
+static i2c_hw_t      host_i2c_hw[NUM_I2CS];
+static spi_hw_t      host_spi_hw[NUM_SPIS];
+static irq_handler_t host_irq_handlers[HOST_IRQ_COUNT];
+static irq_handler_t host_irq_shared[HOST_IRQ_COUNT][HOST_IRQ_SHARED];
+static bool          host_irq_enabled[HOST_IRQ_COUNT];
+
+static host_i2c_writer_t   host_i2c_writer;
+static bool                host_dma_mocked;
+static bool                host_dma_claimed[NUM_DMA_CHANNELS];
+static bool                host_dma_irq0_enabled[NUM_DMA_CHANNELS];
+static bool                host_dma_irq0_status[NUM_DMA_CHANNELS];
+static host_dma_transfer_t host_dma[NUM_DMA_CHANNELS];
+static uint32_t      host_fifo[HOST_FIFO_DEPTH];
+static uint          host_fifo_head;
+static uint          host_fifo_count;
+
+i2c_inst_t i2c0_inst = { &host_i2c_hw[0] };
+i2c_inst_t i2c1_inst = { &host_i2c_hw[1] };
+spi_inst_t spi0_inst = { &host_spi_hw[0] };
+spi_inst_t spi1_inst = { &host_spi_hw[1] };
+
+
+/* Functions. */
+
+/*
+ * sleep_ms / sleep_us; just sleep the calling thread.
+ */
+
+void sleep_ms( uint32_t p_ms )
+{
+  sleep_us( (uint64_t)p_ms * 1000 );
+  return;
+}
+
+void sleep_us( uint64_t p_us )
+{
+  struct timespec l_delay;
+
+  l_delay.tv_sec = p_us / 1000000;
+  l_delay.tv_nsec = ( p_us % 1000000 ) * 1000;
+  nanosleep( &l_delay, nullptr );
+  return;
+}
+
+
+/*
+ * time_us_64; microseconds from a monotonic clock, like the Pico's timer.
+ */
+
+uint64_t time_us_64( void )
+{
+  struct timespec l_now;
+
+  clock_gettime( CLOCK_MONOTONIC, &l_now );
+  return ( (uint64_t)l_now.tv_sec * 1000000 ) + ( l_now.tv_nsec / 1000 );
+}
+
+
+/*
+ * i2c_write_blocking / spi_write_blocking; there's no bus, so these fail;
+ *                                          unless a test has taken the I2C
+ *                                          writes for itself.
+ */
+
+int i2c_write_blocking( i2c_inst_t *p_i2c, uint8_t p_address, const uint8_t *p_src, size_t p_length, bool p_nostop )
+{
+  if ( host_i2c_writer != nullptr )
+  {
+    return host_i2c_writer( p_i2c, p_address, p_src, p_length, p_nostop );
+  }
+  return PICO_ERROR_GENERIC;
+}
+
+int spi_write_blocking( spi_inst_t *p_spi, const uint8_t *p_src, size_t p_length )
+{
+  return PICO_ERROR_GENERIC;
+}
+
+
+/*
+ * dma_*; there are no channels to be had, unless they're being mocked; then
+ *        a transfer is just remembered, until host_dma_complete finishes it.
+ */
+
+int dma_claim_unused_channel( bool p_required )
+{
+  if ( !host_dma_mocked )
+  {
+    return -1;
+  }
+
+  for ( uint l_channel = 0; l_channel < NUM_DMA_CHANNELS; l_channel++ )
+  {
+    if ( !host_dma_claimed[l_channel] )
+    {
+      host_dma_claimed[l_channel] = true;
+      return l_channel;
+    }
+  }
+  return -1;
+}
+
+void dma_channel_claim( uint p_channel )
+{
+  if ( p_channel < NUM_DMA_CHANNELS )
+  {
+    host_dma_claimed[p_channel] = true;
+  }
+  return;
+}
+
+void dma_channel_unclaim( uint p_channel )
+{
+  if ( p_channel < NUM_DMA_CHANNELS )
+  {
+    host_dma_claimed[p_channel] = false;
+    host_dma_irq0_enabled[p_channel] = false;
+    host_dma[p_channel].busy = false;
+  }
+  return;
+}
+
+dma_channel_config dma_channel_get_default_config( uint p_channel )
+{
+  dma_channel_config l_config = { DMA_SIZE_32 };
+  return l_config;
+}
+
+void channel_config_set_transfer_data_size( dma_channel_config *p_config, enum dma_channel_transfer_size p_size )
+{
+  p_config->ctrl = p_size;
+  return;
+}
+
+void channel_config_set_read_increment( dma_channel_config *p_config, bool p_increment )
+{
+  return;
+}
+
+void channel_config_set_write_increment( dma_channel_config *p_config, bool p_increment )
+{
+  return;
+}
+
+void channel_config_set_dreq( dma_channel_config *p_config, uint p_dreq )
+{
+  return;
+}
+
+void dma_channel_configure( uint p_channel, const dma_channel_config *p_config, volatile void *p_write,
+                            const volatile void *p_read, uint p_count, bool p_trigger )
+{
+  if ( p_channel >= NUM_DMA_CHANNELS )
+  {
+    return;
+  }
+
+  host_dma[p_channel].size = (enum dma_channel_transfer_size)p_config->ctrl;
+  host_dma[p_channel].write = p_write;
+  host_dma[p_channel].read = p_read;
+  host_dma[p_channel].count = p_count;
+  host_dma[p_channel].busy = p_trigger;
+  return;
+}
+
+void dma_channel_abort( uint p_channel )
+{
+  if ( p_channel < NUM_DMA_CHANNELS )
+  {
+    host_dma[p_channel].busy = false;
+  }
+  return;
+}
+
+void dma_channel_set_irq0_enabled( uint p_channel, bool p_enabled )
+{
+  if ( p_channel < NUM_DMA_CHANNELS )
+  {
+    host_dma_irq0_enabled[p_channel] = p_enabled;
+  }
+  return;
+}
+
+bool dma_channel_get_irq0_status( uint p_channel )
+{
+  return ( p_channel < NUM_DMA_CHANNELS ) && host_dma_irq0_status[p_channel];
+}
+
+void dma_channel_acknowledge_irq0( uint p_channel )
+{
+  if ( p_channel < NUM_DMA_CHANNELS )
+  {
+    host_dma_irq0_status[p_channel] = false;
+  }
+  return;
+}
+
+
+/*
+ * irq_*; handlers are remembered, but only called by host_irq_raise.
+ */
+
+void irq_set_exclusive_handler( uint p_num, irq_handler_t p_handler )
+{
+  if ( p_num < HOST_IRQ_COUNT )
+  {
+    host_irq_handlers[p_num] = p_handler;
+  }
+  return;
+}
+
+irq_handler_t irq_get_exclusive_handler( uint p_num )
+{
+  return ( p_num < HOST_IRQ_COUNT ) ? host_irq_handlers[p_num] : nullptr;
+}
+
+void irq_add_shared_handler( uint p_num, irq_handler_t p_handler, uint8_t p_priority )
+{
+  if ( p_num >= HOST_IRQ_COUNT )
+  {
+    return;
+  }
+
+  for ( uint l_index = 0; l_index < HOST_IRQ_SHARED; l_index++ )
+  {
+    if ( host_irq_shared[p_num][l_index] == nullptr )
+    {
+      host_irq_shared[p_num][l_index] = p_handler;
+      break;
+    }
+  }
+  return;
+}
+
+void irq_set_enabled( uint p_num, bool p_enabled )
+{
+  if ( p_num < HOST_IRQ_COUNT )
+  {
+    host_irq_enabled[p_num] = p_enabled;
+  }
+  return;
+}
+
+
+/*
+ * gpio_*; there are no pins.
+ */
+
+void gpio_init( uint p_gpio )
+{
+  return;
+}
+
+void gpio_set_dir( uint p_gpio, bool p_out )
+{
+  return;
+}
+
+void gpio_put( uint p_gpio, bool p_value )
+{
+  return;
+}
+
+
+/*
+ * multicore_*; there's no core1, so launching does nothing and the FIFO is
+ *              just a simple queue.
+ */
+
+void multicore_launch_core1( void (*p_entry)( void ) )
+{
+  return;
+}
+
+bool multicore_fifo_rvalid( void )
+{
+  return host_fifo_count > 0;
+}
+
+void multicore_fifo_push_blocking( uint32_t p_data )
+{
+  if ( host_fifo_count < HOST_FIFO_DEPTH )
+  {
+    host_fifo[( host_fifo_head + host_fifo_count++ ) % HOST_FIFO_DEPTH] = p_data;
+  }
+  return;
+}
+
+uint32_t multicore_fifo_pop_blocking( void )
+{
+  uint32_t l_data;
+
+  if ( host_fifo_count == 0 )
+  {
+    return 0;
+  }
+  l_data = host_fifo[host_fifo_head];
+  host_fifo_head = ( host_fifo_head + 1 ) % HOST_FIFO_DEPTH;
+  host_fifo_count--;
+  return l_data;
+}
+
+
+/*
+ * host_i2c_set_writer; hands every blocking I2C write to the given function,
+ *                      or (if that's null) lets them fail again.
+ */
+
+void host_i2c_set_writer( host_i2c_writer_t p_writer )
+{
+  host_i2c_writer = p_writer;
+  return;
+}
+
+
+/*
+ * host_i2c_event; internal function that raises the given events on an I2C
+ *                 block, and its interrupt if any of them are unmasked.
+ */
+
+static void host_i2c_event( uint p_index, uint32_t p_events )
+{
+  host_i2c_hw[p_index].intr_stat = p_events & host_i2c_hw[p_index].intr_mask;
+  if ( host_i2c_hw[p_index].intr_stat != 0 )
+  {
+    host_irq_raise( I2C0_IRQ + p_index );
+  }
+  return;
+}
+
+
+/*
+ * host_i2c_abort; aborts whatever the I2C block is sending, as a missing ACK
+ *                 would.
+ */
+
+void host_i2c_abort( i2c_inst_t *p_i2c )
+{
+  host_i2c_event( i2c_hw_index( p_i2c ), I2C_IC_INTR_STAT_R_TX_ABRT_BITS );
+  return;
+}
+
+
+/*
+ * host_dma_mock; switches the DMA mock on (or off again); while it's on, DMA
+ *                channels can be claimed.
+ */
+
+void host_dma_mock( bool p_enabled )
+{
+  host_dma_mocked = p_enabled;
+  return;
+}
+
+
+/*
+ * host_dma_transfer; returns the transfer last set up on a channel, or null
+ *                    if there's no such channel.
+ */
+
+const host_dma_transfer_t *host_dma_transfer( uint p_channel )
+{
+  return ( p_channel < NUM_DMA_CHANNELS ) ? &host_dma[p_channel] : nullptr;
+}
+
+
+/*
+ * host_dma_complete; finishes the transfer in flight on a channel, raising
+ *                    its interrupt if that's enabled. A stream into an I2C
+ *                    block ends in a STOP, so that is then flagged too.
+ */
+
+void host_dma_complete( uint p_channel )
+{
+  if ( p_channel >= NUM_DMA_CHANNELS || !host_dma[p_channel].busy )
+  {
+    return;
+  }
+  host_dma[p_channel].busy = false;
+
+  if ( host_dma_irq0_enabled[p_channel] )
+  {
+    host_dma_irq0_status[p_channel] = true;
+    host_irq_raise( DMA_IRQ_0 );
+  }
+
+  for ( uint l_index = 0; l_index < NUM_I2CS; l_index++ )
+  {
+    if ( host_dma[p_channel].write == &host_i2c_hw[l_index].data_cmd )
+    {
+      host_i2c_event( l_index, I2C_IC_INTR_STAT_R_STOP_DET_BITS );
+    }
+  }
+  return;
+}
+
+
+/*
+ * host_irq_raise; calls the handler (or handlers, if it's shared) for an
+ *                 interrupt, if it's enabled.
+ */
+
+void host_irq_raise( uint p_num )
+{
+  if ( p_num >= HOST_IRQ_COUNT || !host_irq_enabled[p_num] )
+  {
+    return;
+  }
+
+  if ( host_irq_handlers[p_num] != nullptr )
+  {
+    host_irq_handlers[p_num]();
+    return;
+  }
+  for ( uint l_index = 0; l_index < HOST_IRQ_SHARED; l_index++ )
+  {
+    if ( host_irq_shared[p_num][l_index] != nullptr )
+    {
+      host_irq_shared[p_num][l_index]();
+    }
+  }
+  return;
+}
+
+
+/* End of file pico-host.cpp */
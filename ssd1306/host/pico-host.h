@@ -0,0 +1,43 @@
+/*
+ * pico-host.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Hooks into the host stand-ins of pico-host.cpp, for tests. They let a test
+ * see the blocking I2C writes, switch on a mock of the DMA channels (whose
+ * transfers are only finished when the test says so) and raise the
+ * interrupts that signal it. None of this exists on the Pico.
+ */
+
+#ifndef   PAL_HOST_PICO_HOST_H
+#define   PAL_HOST_PICO_HOST_H
+
+#include <pico/stdlib.h>
+#include <hardware/i2c.h>
+#include <hardware/dma.h>
+
+/* Stands in for i2c_write_blocking, once set; returns what it would. */
+typedef int (*host_i2c_writer_t)( i2c_inst_t *p_i2c, uint8_t p_address, const uint8_t *p_src,
+                                  size_t p_length, bool p_nostop );
+
+/* A DMA transfer, as set up on a mocked channel. */
+typedef struct
+{
+  bool                           busy;
+  enum dma_channel_transfer_size size;
+  volatile void                 *write;
+  const volatile void           *read;
+  uint                           count;
+} host_dma_transfer_t;
+
+void                       host_i2c_set_writer( host_i2c_writer_t p_writer );
+void                       host_i2c_abort( i2c_inst_t *p_i2c );
+void                       host_dma_mock( bool p_enabled );
+const host_dma_transfer_t *host_dma_transfer( uint p_channel );
+void                       host_dma_complete( uint p_channel );
+void                       host_irq_raise( uint p_num );
+
+#endif /* PAL_HOST_PICO_HOST_H */
+
+/* End of file pico-host.h */
@@ -0,0 +1,25 @@
+/*
+ * pico/multicore.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A host stand-in for the Pico SDK header of the same name. There is no
+ * core1 to launch, and the FIFO only carries 32 bit values (too small for
+ * a host pointer), so rendering on core1 isn't supported off the Pico;
+ * enable_core1 fails there.
+ */
+
+#ifndef   PAL_HOST_PICO_MULTICORE_H
+#define   PAL_HOST_PICO_MULTICORE_H
+
+#include <pico/stdlib.h>
+
+void     multicore_launch_core1( void (*p_entry)( void ) );
+bool     multicore_fifo_rvalid( void );
+void     multicore_fifo_push_blocking( uint32_t p_data );
+uint32_t multicore_fifo_pop_blocking( void );
+
+#endif /* PAL_HOST_PICO_MULTICORE_H */
+
+/* End of file pico/multicore.h */
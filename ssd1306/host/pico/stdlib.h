@@ -0,0 +1,46 @@
+/*
+ * pico/stdlib.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A host stand-in for the Pico SDK header of the same name, covering just
+ * what pal-ssd1306 uses, so that the driver can be built and run off the
+ * Pico (on a Linux SBC, or for testing). See pico-host.cpp.
+ */
+
+#ifndef   PAL_HOST_PICO_STDLIB_H
+#define   PAL_HOST_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+/* This is never the Pico itself. */
+#define PICO_ON_DEVICE 0
+
+#define NUM_I2CS 2
+#define NUM_SPIS 2
+
+#define PICO_OK            0
+#define PICO_ERROR_GENERIC -1
+
+static inline void tight_loop_contents( void )
+{
+}
+
+/* stdio is always there on a host. */
+static inline bool stdio_init_all( void )
+{
+  return true;
+}
+
+void     sleep_ms( uint32_t p_ms );
+void     sleep_us( uint64_t p_us );
+uint64_t time_us_64( void );
+
+#endif /* PAL_HOST_PICO_STDLIB_H */
+
+/* End of file pico/stdlib.h */
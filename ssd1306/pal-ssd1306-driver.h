@@ -0,0 +1,1399 @@
+/*
+ * pal-ssd1306-driver.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * The SSD1306Driver template; everything which talks to the display, through
+ * the transport it is given. This is included by pal-ssd1306.h, and should
+ * not need including directly.
+ */
+
+#ifndef   PAL_SSD1306_DRIVER_H
+#define   PAL_SSD1306_DRIVER_H
+
+#include <string.h>
+
+#include <pico/stdlib.h>
+#include <pico/multicore.h>
+#include <hardware/sync.h>
+
+
+/* Constants. */
+
+/* 
+ * The cost, in bytes on the wire, of starting a new column window within a
+ * page: the COLUMNADDR transaction (address, control and three command bytes)
+ * and the address and control bytes of the data that follows. Gaps of
+ * unchanged bytes shorter than this are cheaper to resend than to skip.
+ */
+
+#define SSD1306_WINDOW_COST 7
+
+
+/* Functions. */
+
+/*
+ * Constructor; initialises the device over the given transport, using the
+ *              screen buffer provided or allocating one if that is null. A
+ *              provided buffer must be at least buffer_size() bytes long,
+ *              and remains owned by (and so must be freed by) the caller.
+ */
+
+template<class Transport>
+pal::SSD1306Driver<Transport>::SSD1306Driver( uint8_t p_width, uint8_t p_height, uint8_t *p_buffer,
+                                              const Transport &p_transport, bool p_ext_vcc )
+  : SSD1306Canvas( p_width, p_height, p_buffer ), transport( p_transport )
+{
+  /* Save our basic parameters. */
+  external_vcc = p_ext_vcc;
+
+  /* Until double buffering is enabled, we render from the same buffer. */
+  double_buffered = false;
+  front_buffer = screen_buffer;
+  second_buffer = nullptr;
+  owns_second_buffer = false;
+
+  /* Likewise we only use the visible part of the display memory, for now. */
+  page_flip = false;
+  page_offset = 0;
+
+  /* And we render on this core, unless asked not to. */
+  core1_mode = false;
+  frame_policy = FRAME_LATEST;
+  core1_renderer = core1_frame;
+  mailbox_mode = false;
+
+  /* Default to tracking dirty areas as we draw, without a shadow frame. */
+  render_mode = RENDER_DIRTY;
+  shadow_buffer = nullptr;
+  shadow_valid = false;
+  owns_shadow = false;
+
+  /* No asynchronous render has been started, so none has failed. */
+  async_cb = nullptr;
+  async_cb_context = nullptr;
+  async_failed = false;
+
+  /* We have no idea what's on the display to start with, so it's all dirty. */
+  invalidate();
+
+  /* No commands are queued up yet. */
+  cmd_length = 0;
+  cmd_batching = false;
+
+  /* Last thing to do is to send our initialisation commands to the device, */
+  /* as a single transaction. This command sequence is mostly derived from  */
+  /* Adafruits SSD1306 driver.                                               */
+  transport.begin();
+  queue_cmd( DISPLAYOFF );
+  queue_cmd( SETDISPLAYCLOCKDIV, 0x80 );
+  queue_cmd( SETMULTIPLEX, height - 1 );
+  queue_cmd( SETDISPLAYOFFSET, 0x00 );
+  queue_cmd( SETSTARTLINE );
+  queue_cmd( CHARGEPUMP, external_vcc ? 0x10 : 0x14 );
+  queue_cmd( MEMORYMODE, 0x00 );
+  queue_cmd( SEGREMAP );
+  queue_cmd( COMSCANDEC );
+  queue_cmd( SETCOMPINS, height == 64 ? 0x12 : 0x02 );
+  queue_cmd( SETCONTRAST, 0xFF );
+  queue_cmd( SETPRECHARGE, external_vcc ? 0x22 : 0xF1 );
+  queue_cmd( SETVCOMDETECT, 0x40 );
+  queue_cmd( DISPLAYALLON );
+  queue_cmd( NORMALDISPLAY );
+  queue_cmd( DISPLAYON );
+  flush_cmds();
+
+  /* All sorted then. */
+  return;
+}
+
+
+/*
+ * Constructor; initialises the device over the given transport, allocating
+ *              the screen buffer.
+ */
+
+template<class Transport>
+pal::SSD1306Driver<Transport>::SSD1306Driver( uint8_t p_width, uint8_t p_height,
+                                              const Transport &p_transport, bool p_ext_vcc )
+  : SSD1306Driver( p_width, p_height, nullptr, p_transport, p_ext_vcc )
+{
+  return;
+}
+
+
+/*
+ * Destructor; frees up the extra buffers; the screen buffer itself belongs
+ *             to the canvas.
+ */
+
+template<class Transport>
+pal::SSD1306Driver<Transport>::~SSD1306Driver()
+{
+  /* Make sure any in-flight render is finished with our buffers. */
+  wait_for_core1();
+  while ( transport.is_busy() )
+  {
+    tight_loop_contents();
+  }
+
+  /* Put the buffers back where they started if they've been swapped */
+  /* around, so we free the right ones.                               */
+  if ( screen_buffer == second_buffer )
+  {
+    screen_buffer = front_buffer;
+  }
+  if ( mailbox_mode )
+  {
+    screen_buffer = mailbox_buffers[0];
+  }
+  if ( owns_second_buffer )
+  {
+    delete[] second_buffer;
+  }
+  second_buffer = front_buffer = nullptr;
+  if ( owns_shadow )
+  {
+    delete[] shadow_buffer;
+  }
+  shadow_buffer = nullptr;
+
+  /* That's all! */
+  return;
+}
+
+
+/*
+ * queue_bytes; internal function that appends raw command bytes to the 
+ *              command buffer, so that a whole sequence can be sent in a
+ *              single write by flush_cmds. While gathering a batch, which
+ *              has to go out as a single write, anything that won't fit is
+ *              refused (and false returned); otherwise overly long sequences
+ *              are split across writes.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::queue_bytes( const uint8_t *p_bytes, size_t p_length )
+{
+  /* A batch can't be split, so it has to fit behind the one control byte. */
+  if ( cmd_batching && ( cmd_length > 0 ? cmd_length : 1 ) + p_length > SSD1306_CMD_BUFFER_SZ )
+  {
+    return false;
+  }
+
+  /* Keep the sequence in one transaction, if it'll fit in one at all. */
+  if ( cmd_length + p_length > SSD1306_CMD_BUFFER_SZ )
+  {
+    flush_cmds();
+  }
+
+  for ( size_t l_index = 0; l_index < p_length; l_index++ )
+  {
+    /* Overly long sequences just have to be split. */
+    if ( cmd_length == SSD1306_CMD_BUFFER_SZ )
+    {
+      flush_cmds();
+    }
+
+    /* A fresh buffer starts with a spare byte, which the transport can  */
+    /* borrow for a control byte; over I2C, Co=0 and D/C#=0 mean that    */
+    /* every byte that follows is a command (or argument) byte.          */
+    if ( cmd_length == 0 )
+    {
+      cmd_buffer[cmd_length++] = 0x00;
+    }
+    cmd_buffer[cmd_length++] = p_bytes[l_index];
+  }
+  return true;
+}
+
+
+/*
+ * queue_cmd; internal function that appends a command (and its arguments) to
+ *            the command buffer.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::queue_cmd( ssd1306_cmd_t p_cmd, int16_t p_arg1, int16_t p_arg2 )
+{
+  uint8_t l_bytes[3];
+  uint8_t l_length = 0;
+
+  l_bytes[l_length++] = p_cmd;
+  if ( p_arg1 >= 0 )
+  {
+    l_bytes[l_length++] = p_arg1 & 0xFF;
+  }
+  if ( p_arg2 >= 0 )
+  {
+    l_bytes[l_length++] = p_arg2 & 0xFF;
+  }
+
+  return queue_bytes( l_bytes, l_length );
+}
+
+
+/*
+ * flush_cmds; internal function to send any queued commands to the display,
+ *             in a single transaction. If hold is set, the transport may
+ *             hold the bus so that following data goes out in the same bus
+ *             session.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::flush_cmds( bool p_hold )
+{
+  bool l_result;
+
+  /* Nothing to do if nothing is queued. */
+  if ( cmd_length == 0 )
+  {
+    return true;
+  }
+
+  /* Send it, and empty the buffer regardless of how that went. */
+  l_result = transport.write_commands( cmd_buffer + 1, cmd_length - 1, p_hold );
+  SSD1306_STAT( stats_write( cmd_length - 1, l_result ) );
+  cmd_length = 0;
+  return l_result;
+}
+
+
+/*
+ * write_cmd; internal function that sends a single command sequence to the 
+ *            display, along with anything already queued - unless we're in
+ *            the middle of gathering commands, when it's just queued.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::write_cmd( ssd1306_cmd_t p_cmd, int16_t p_arg1, int16_t p_arg2 )
+{
+  if ( cmd_batching )
+  {
+    return queue_cmd( p_cmd, p_arg1, p_arg2 );
+  }
+  queue_cmd( p_cmd, p_arg1, p_arg2 );
+  return flush_cmds();
+}
+
+
+/*
+ * render; sends the changed areas of the screen buffer to the display; each
+ *         page is sent as a single window covering its dirty columns, or in
+ *         shadow mode as the windows which differ from the last frame sent.
+ *         When double buffered, it's the front buffer that gets sent. When
+ *         rendering on core1, this swaps the buffers and hands the frame
+ *         over, returning straight away. Returns false if anything failed to
+ *         send (on core1, only if the frame was dropped - failures there are
+ *         only counted, in stats()); whatever failed stays dirty, and is
+ *         sent again by the next render.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::render( void )
+{
+  uint8_t l_index;
+
+  SSD1306_STAT( stats_latch_pixels() );
+
+  if ( core1_mode )
+  {
+    return post_frame();
+  }
+
+  /* With a mailbox, send the newest published frame - if there is one. We */
+  /* can't know what changed across the frames we skipped, so it's all     */
+  /* dirty; shadow mode is the way to trim that down.                      */
+  if ( mailbox_mode )
+  {
+    if ( !mailbox.acquire( &l_index ) )
+    {
+      /* Nothing new, but we still hold the last frame if it didn't all */
+      /* make it to the display; and commands held for this render go   */
+      /* out regardless.                                                */
+      return front_dirty() ? render_frame() : flush_cmds();
+    }
+    front_buffer = mailbox_buffers[l_index];
+    for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+    {
+      front_min[l_page] = 0;
+      front_max[l_page] = width - 1;
+    }
+  }
+
+  return render_frame();
+}
+
+
+/*
+ * render_frame; internal function which does the actual rendering, on which
+ *               ever core render has been given to.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::render_frame( void )
+{
+  uint8_t l_page;
+  bool    l_full, l_sent;
+  bool    l_result;
+#if SSD1306_STATS
+  uint64_t l_start = time_us_64();
+  size_t   l_dirty = 0;
+#endif
+
+  /* If the last asynchronous render failed, the display needs catching up. */
+  check_async();
+
+  /* With a single buffer, we're rendering what's been drawn so far. */
+  if ( !double_buffered && !mailbox_mode )
+  {
+    latch_dirty();
+  }
+
+  /* When page flipping, the hidden half is a frame behind as well. */
+  if ( page_flip )
+  {
+    merge_flip_dirty();
+  }
+
+  /* Work out how much is dirty, and whether that's everything. */
+  l_full = true;
+  for ( l_page = 0; l_page < pagesize; l_page++ )
+  {
+    if ( front_min[l_page] != 0 || front_max[l_page] != width - 1 )
+    {
+      l_full = false;
+    }
+#if SSD1306_STATS
+    if ( front_min[l_page] <= front_max[l_page] )
+    {
+      l_dirty += front_max[l_page] - front_min[l_page] + 1;
+    }
+#endif
+  }
+
+  /* Shadow mode does its own thing, once the shadow frame is populated; */
+  /* the shadow only tracks one frame though, so not when page flipping. */
+  if ( render_mode == RENDER_SHADOW && shadow_valid && !page_flip )
+  {
+    l_result = render_shadow();
+  }
+  else if ( l_full )
+  {
+    /* Every page is dirty from edge to edge, so send it all in one go; */
+    /* set the page and column ranges to cover the whole display,       */
+    /* holding the bus so the data follows on in the same session.      */
+    queue_cmd( PAGEADDR, page_offset, page_offset + pagesize - 1 );
+    queue_cmd( COLUMNADDR, 0, width - 1 );
+    l_result = flush_cmds( true );
+
+    /* Then, write the whole screen buffer; if that (or the window) fails, */
+    /* it all stays dirty, so the next render tries again.                 */
+    l_sent = transport.write_data( front_buffer + 1, screen_buffer_sz - 1 );
+    SSD1306_STAT( stats_write( screen_buffer_sz - 1, l_sent ) );
+    if ( l_sent && l_result )
+    {
+      clear_dirty();
+
+      /* And if we're shadowing, this is now what the display holds. */
+      if ( render_mode == RENDER_SHADOW )
+      {
+        memcpy( shadow_buffer, front_buffer + 1, screen_buffer_sz - 1 );
+        shadow_valid = true;
+      }
+    }
+
+    /* Only show the hidden half once it's all there. */
+    if ( l_sent && l_result )
+    {
+      l_result = flip_page();
+    }
+    else
+    {
+      keep_flip_dirty();
+      l_result = false;
+    }
+  }
+  else
+  {
+    /* Otherwise, work through the pages sending just the dirty windows. */
+    l_result = true;
+    l_sent = false;
+    for ( l_page = 0; l_page < pagesize; l_page++ )
+    {
+      if ( front_min[l_page] > front_max[l_page] )
+      {
+        continue;
+      }
+
+      /* A window that fails to send stays dirty, to be tried again. */
+      if ( write_window( l_page, front_min[l_page], front_max[l_page], true ) )
+      {
+        front_min[l_page] = 0xFF;
+        front_max[l_page] = 0;
+      }
+      else
+      {
+        l_result = false;
+      }
+      l_sent = true;
+    }
+
+    /* No need to flip if nothing changed, and no flipping to a half */
+    /* that's only partly written; the next render finishes it.      */
+    if ( l_sent && l_result )
+    {
+      l_result = flip_page();
+    }
+    else if ( !l_result )
+    {
+      keep_flip_dirty();
+    }
+  }
+
+  /* Commands held for this render by commit normally go out with the */
+  /* first window; if there was nothing to send, they go on their own. */
+  l_result = flush_cmds() && l_result;
+
+  SSD1306_STAT( stats_frame( l_start, l_dirty ) );
+  return l_result;
+}
+
+
+/*
+ * invalidate; marks the whole screen as dirty, so that the next render sends
+ *             everything - handy if the display has been reset or disturbed.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::invalidate( void )
+{
+  wait_for_core1();
+
+  /* Both buffers need sending, and the shadow can't be trusted either. */
+  set_dirty();
+  for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+  {
+    front_min[l_page] = 0;
+    front_max[l_page] = width - 1;
+  }
+  shadow_valid = false;
+
+  /* And the hidden half, if we're page flipping, needs a full refresh. */
+  for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+  {
+    flip_min[l_page] = 0;
+    flip_max[l_page] = width - 1;
+  }
+  return;
+}
+
+
+/*
+ * set_render_mode; selects how render works out what to send. RENDER_DIRTY
+ *                  (the default) sends the areas touched by drawing since the
+ *                  last render. RENDER_SHADOW keeps a copy of the last frame
+ *                  sent and only sends what actually differs from it, which
+ *                  suits code that clears and redraws the whole screen each
+ *                  frame; it costs another screen's worth of memory, which
+ *                  can be provided (buffer_size() - 1 bytes) or is allocated.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::set_render_mode( ssd1306_render_mode_t p_mode, uint8_t *p_shadow )
+{
+  wait_for_core1();
+
+  /* Switch to a provided shadow frame, if we've been given one. */
+  if ( p_shadow != nullptr && p_shadow != shadow_buffer )
+  {
+    if ( owns_shadow )
+    {
+      delete[] shadow_buffer;
+    }
+    shadow_buffer = p_shadow;
+    owns_shadow = false;
+  }
+
+  /* Allocate the shadow frame if we need it, and don't already have one. */
+  if ( p_mode == RENDER_SHADOW && shadow_buffer == nullptr )
+  {
+    shadow_buffer = new uint8_t[screen_buffer_sz - 1];
+    if ( shadow_buffer == nullptr )
+    {
+      return false;
+    }
+    owns_shadow = true;
+  }
+
+  /* Save the mode, and make sure the next render brings everything in line. */
+  render_mode = p_mode;
+  invalidate();
+  return true;
+}
+
+
+/*
+ * enable_double_buffer; adds a second screen buffer (which can be provided,
+ *                       buffer_size() bytes, or is allocated) so that drawing
+ *                       goes to a back buffer while render sends the front
+ *                       one; swap() then exchanges them.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::enable_double_buffer( uint8_t *p_buffer )
+{
+  /* Nothing to do if we're already set up; no use with a mailbox, either. */
+  if ( double_buffered )
+  {
+    return true;
+  }
+  if ( mailbox_mode )
+  {
+    return false;
+  }
+
+  /* Allocate the second buffer, unless we've been given one. */
+  owns_second_buffer = ( p_buffer == nullptr );
+  second_buffer = owns_second_buffer ? new uint8_t[screen_buffer_sz] : p_buffer;
+  if ( second_buffer == nullptr )
+  {
+    return false;
+  }
+
+  /* What we've drawn so far becomes the front buffer, and drawing carries */
+  /* on in a copy of it.                                                    */
+  memcpy( second_buffer, screen_buffer, screen_buffer_sz );
+  latch_dirty();
+  front_buffer = screen_buffer;
+  screen_buffer = second_buffer;
+  screen_ptr = screen_buffer + 1;
+  double_buffered = true;
+  return true;
+}
+
+
+/*
+ * swap; makes the back buffer (the one being drawn on) the front buffer, to
+ *       be sent by the next render. If preserve is set, the new back buffer
+ *       starts as a copy of it so drawing can carry on incrementally; if not,
+ *       it holds an older frame and should be redrawn from scratch.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::swap( bool p_preserve )
+{
+  uint8_t *l_buffer;
+
+  /* Without a second buffer, there's nothing to swap. */
+  if ( !double_buffered )
+  {
+    return;
+  }
+
+  /* Don't pull the front buffer out from under a render. */
+  wait_for_core1();
+  while ( transport.is_busy() )
+  {
+    tight_loop_contents();
+  }
+
+  /* Whatever was drawn now needs rendering from the front buffer. */
+  latch_dirty();
+
+  /* Switch the buffers over. */
+  l_buffer = front_buffer;
+  front_buffer = screen_buffer;
+  screen_buffer = l_buffer;
+  screen_ptr = screen_buffer + 1;
+
+  /* And bring the back buffer up to date, if asked to. */
+  if ( p_preserve )
+  {
+    memcpy( screen_ptr, front_buffer + 1, screen_buffer_sz - 1 );
+  }
+  return;
+}
+
+
+/*
+ * enable_page_flip; on displays of 32 rows or less, only half of the display
+ *                   memory is visible. This renders each frame into the other
+ *                   half and then flips the visible half (with SETSTARTLINE)
+ *                   so that each new frame appears at once, without tearing
+ *                   and without needing any more memory. Returns false if the
+ *                   display is too tall for this.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::enable_page_flip( void )
+{
+  wait_for_core1();
+
+  /* We need room for two whole frames in the display memory. */
+  if ( pagesize * 2 > SSD1306_MAX_PAGES )
+  {
+    return false;
+  }
+
+  /* The first frame goes into the hidden half, which holds who knows what. */
+  page_flip = true;
+  page_offset = pagesize;
+  invalidate();
+  return true;
+}
+
+
+/*
+ * flip_page; internal function which, when page flipping, shows the half of
+ *            the display memory just rendered to and switches to the other;
+ *            unless the command fails, in which case the next render goes
+ *            back to the same half.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::flip_page( void )
+{
+  bool l_result;
+
+  if ( !page_flip )
+  {
+    return true;
+  }
+
+  /* If the panel didn't get the command, the hidden half is still hidden. */
+  l_result = write_cmd( (ssd1306_cmd_t)( SETSTARTLINE | ( page_offset * 8 ) ) );
+  if ( l_result )
+  {
+    page_offset = page_offset ? 0 : pagesize;
+  }
+  else
+  {
+    keep_flip_dirty();
+  }
+  return l_result;
+}
+
+
+/*
+ * enable_mailbox; sets the display up for drawing and rendering on different
+ *                 cores (or in an interrupt driven pipeline), with three
+ *                 screen buffers passed between them without any locking.
+ *                 The two extra buffers can be provided (2 * buffer_size()
+ *                 bytes) or are allocated. The producer draws as normal and
+ *                 calls publish() when a frame is complete; the consumer
+ *                 calls render(), which sends the newest published frame
+ *                 (or nothing, if there's nothing new). This can't be used
+ *                 alongside double buffering.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::enable_mailbox( uint8_t *p_buffers )
+{
+  /* Nothing to do if we're already set up; no use with double buffering. */
+  if ( mailbox_mode )
+  {
+    return true;
+  }
+  if ( double_buffered )
+  {
+    return false;
+  }
+
+  /* Allocate the extra buffers, unless we've been given them. */
+  owns_second_buffer = ( p_buffers == nullptr );
+  second_buffer = owns_second_buffer ? new uint8_t[screen_buffer_sz * 2] : p_buffers;
+  if ( second_buffer == nullptr )
+  {
+    return false;
+  }
+  mailbox_buffers[0] = screen_buffer;
+  mailbox_buffers[1] = second_buffer;
+  mailbox_buffers[2] = second_buffer + screen_buffer_sz;
+
+  /* What we've drawn so far becomes the first published frame, and drawing */
+  /* carries on in a copy of it.                                             */
+  mailbox.reset();
+  screen_buffer = mailbox_buffers[mailbox.draw_index()];
+  memcpy( screen_buffer, mailbox_buffers[0], screen_buffer_sz );
+  screen_ptr = screen_buffer + 1;
+  mailbox_mode = true;
+  return true;
+}
+
+
+/*
+ * publish; hands the frame just drawn over to the consumer, and carries on
+ *          drawing in a free buffer. This never waits. If preserve is set,
+ *          the new buffer starts as a copy of the frame just published; if
+ *          not, it holds an older frame and should be redrawn from scratch.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::publish( bool p_preserve )
+{
+  uint8_t *l_published = screen_buffer;
+
+  if ( !mailbox_mode )
+  {
+    return;
+  }
+
+  /* Swap into the free buffer; the consumer only ever reads the published */
+  /* frames, so it's fine for us to copy from one.                         */
+  screen_buffer = mailbox_buffers[mailbox.publish()];
+  screen_ptr = screen_buffer + 1;
+  if ( p_preserve )
+  {
+    memcpy( screen_ptr, l_published + 1, screen_buffer_sz - 1 );
+  }
+
+  /* The drawing side's dirty areas aren't used with a mailbox. */
+  for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+  {
+    dirty_min[l_page] = 0xFF;
+    dirty_max[l_page] = 0;
+  }
+  return;
+}
+
+
+/*
+ * enable_core1; moves rendering onto core1, so that render() only has to hand
+ *               over a frame and the I2C transfer happens there instead. This
+ *               enables double buffering, with render() swapping for you. If
+ *               launch is set, core1 is started running core1_worker(); if
+ *               not, the application's own core1 code must call either that
+ *               or core1_service() regularly. Either way, the multicore FIFO
+ *               is used to pass frames so shouldn't be used for anything
+ *               else. The policy decides what render() does if core1 is
+ *               still busy with the last frame; FRAME_BLOCK waits for it,
+ *               FRAME_LATEST drops the new frame (it will be superseded by
+ *               the next render) and returns immediately. There is no
+ *               core1 off the Pico, so there this always fails.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::enable_core1( ssd1306_frame_policy_t p_policy, bool p_launch )
+{
+#if PICO_ON_DEVICE
+  /* Core1 needs a frame of its own to send while we draw the next one. */
+  if ( !enable_double_buffer() )
+  {
+    return false;
+  }
+
+  /* Save the settings. */
+  frame_policy = p_policy;
+  core1_mode = true;
+
+  /* And start up the worker, if required - it serves every display. */
+  if ( p_launch && !core1_launched )
+  {
+    multicore_launch_core1( core1_worker );
+    core1_launched = true;
+  }
+  return true;
+#else
+  /* The host FIFO can't carry a pointer, and there's no core1 to read it. */
+  (void)p_policy;
+  (void)p_launch;
+  return false;
+#endif
+}
+
+
+/*
+ * post_frame; internal function that hands the back buffer over to core1 to
+ *             be rendered. Only core0 sets core1_busy, and only core1 clears
+ *             it, so no locking is needed. Any callback goes along with the
+ *             frame, and is called on core1 once it's sent; or straight away
+ *             if the frame is dropped, in which case this returns false.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::post_frame( ssd1306_frame_cb_t p_callback, void *p_context )
+{
+  /* Decide what to do if core1 still has the last frame. */
+  if ( core1_busy )
+  {
+    if ( frame_policy == FRAME_LATEST )
+    {
+      if ( p_callback != nullptr )
+      {
+        p_callback( FRAME_DROPPED, p_context );
+      }
+      return false;
+    }
+    wait_for_core1();
+  }
+
+  /* Swap the buffers (keeping what we've drawn) and send the frame over; */
+  /* the FIFO carries 32 bits, which on the Pico is a whole pointer.       */
+#if PICO_ON_DEVICE
+  static_assert( sizeof( uintptr_t ) <= sizeof( uint32_t ), "core1 frames are passed as 32 bit pointers" );
+#endif
+  swap( true );
+  async_cb = p_callback;
+  async_cb_context = p_context;
+  core1_busy = true;
+  __dmb();
+  multicore_fifo_push_blocking( (uint32_t)(uintptr_t)static_cast<SSD1306Canvas *>( this ) );
+  return true;
+}
+
+
+/*
+ * write_window; internal function to send a range of columns from a page to
+ *               the display; the page address is only set if requested, as
+ *               it need only be sent once for several windows on a page.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::write_window( uint8_t p_page, uint8_t p_first, uint8_t p_last, bool p_set_page )
+{
+  bool l_result, l_sent;
+
+  /* Set up the window, in a single transaction that holds on to the bus. */
+  if ( p_set_page )
+  {
+    queue_cmd( PAGEADDR, page_offset + p_page, page_offset + p_page );
+  }
+  queue_cmd( COLUMNADDR, p_first, p_last );
+  l_result = flush_cmds( true );
+
+  /* Then send the window itself; the transport may borrow the byte just */
+  /* before it, and there's always one thanks to the leading byte.        */
+  l_sent = transport.write_data( front_buffer + 1 + ( width * p_page ) + p_first, p_last - p_first + 1 );
+  SSD1306_STAT( stats_write( p_last - p_first + 1, l_sent ) );
+  return l_sent && l_result;
+}
+
+
+/*
+ * render_shadow; internal function to diff each page against the shadow of 
+ *                the last frame sent, and send the windows which differ.
+ *                Runs of changes are merged when the unchanged bytes between
+ *                them cost less to send than starting a new window. Pages
+ *                are only marked clean, and copied into the shadow, once
+ *                every window on them has been sent.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::render_shadow( void )
+{
+  uint8_t  *l_row;
+  uint8_t  *l_shadow;
+  uint16_t  l_column, l_first, l_last, l_gap;
+  bool      l_page_set, l_page_ok;
+  bool      l_result = true;
+
+  for ( uint8_t l_page = 0; l_page < pagesize; l_page++ )
+  {
+    /* Nothing can have changed outside the dirty range. */
+    if ( front_min[l_page] > front_max[l_page] )
+    {
+      continue;
+    }
+
+    l_row = front_buffer + 1 + ( width * l_page );
+    l_shadow = shadow_buffer + ( width * l_page );
+    l_page_set = false;
+    l_page_ok = true;
+    l_column = front_min[l_page];
+
+    while ( l_column <= front_max[l_page] )
+    {
+      /* Skip over anything that hasn't changed. */
+      while ( l_column <= front_max[l_page] && l_row[l_column] == l_shadow[l_column] )
+      {
+        l_column++;
+      }
+      if ( l_column > front_max[l_page] )
+      {
+        break;
+      }
+
+      /* Extend the window until we find a gap worth skipping. */
+      l_first = l_last = l_column;
+      l_gap = 0;
+      for ( l_column++; l_column <= front_max[l_page]; l_column++ )
+      {
+        if ( l_row[l_column] != l_shadow[l_column] )
+        {
+          l_last = l_column;
+          l_gap = 0;
+        }
+        else if ( ++l_gap > SSD1306_WINDOW_COST )
+        {
+          break;
+        }
+      }
+
+      /* Only set the page once we know there's something to send on it. */
+      l_page_ok = write_window( l_page, l_first, l_last, !l_page_set ) && l_page_ok;
+      l_page_set = true;
+      l_column = l_last + 1;
+    }
+
+    /* If anything failed, the shadow (and the dirty range) are left as */
+    /* they were, so the next render diffs against what we know the     */
+    /* display holds, and tries again.                                  */
+    if ( !l_page_ok )
+    {
+      l_result = false;
+      continue;
+    }
+
+    /* Otherwise the display now matches the buffer across the range. */
+    memcpy( l_shadow + front_min[l_page], l_row + front_min[l_page], 
+            front_max[l_page] - front_min[l_page] + 1 );
+    front_min[l_page] = 0xFF;
+    front_max[l_page] = 0;
+  }
+
+  /* All done. */
+  return l_result;
+}
+
+
+/*
+ * latch_dirty; internal function to hand the areas drawn on over to the
+ *              front buffer, ready to be rendered; the drawing side then
+ *              starts again with a clean slate.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::latch_dirty( void )
+{
+  for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+  {
+    if ( dirty_min[l_page] < front_min[l_page] )
+    {
+      front_min[l_page] = dirty_min[l_page];
+    }
+    if ( dirty_max[l_page] > front_max[l_page] )
+    {
+      front_max[l_page] = dirty_max[l_page];
+    }
+    dirty_min[l_page] = 0xFF;
+    dirty_max[l_page] = 0;
+  }
+  return;
+}
+
+
+/*
+ * merge_flip_dirty; internal function for page flipping; the hidden half of
+ *                   the display is two frames old, so it needs the windows
+ *                   changed by the previous render as well as this one.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::merge_flip_dirty( void )
+{
+  uint8_t l_min, l_max;
+
+  for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+  {
+    /* Remember what this frame changed, for the next render. */
+    l_min = front_min[l_page];
+    l_max = front_max[l_page];
+
+    /* And add in what the last one changed. */
+    if ( flip_min[l_page] < front_min[l_page] )
+    {
+      front_min[l_page] = flip_min[l_page];
+    }
+    if ( flip_max[l_page] > front_max[l_page] )
+    {
+      front_max[l_page] = flip_max[l_page];
+    }
+    flip_min[l_page] = l_min;
+    flip_max[l_page] = l_max;
+  }
+  return;
+}
+
+
+/*
+ * keep_flip_dirty; internal function for page flipping, when a render fails
+ *                  and so doesn't flip. The next render goes back into the
+ *                  same hidden half, and the half on show is still missing
+ *                  everything that render sent; so that has to stay dirty,
+ *                  to reach both halves once the flip finally happens.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::keep_flip_dirty( void )
+{
+  if ( !page_flip )
+  {
+    return;
+  }
+
+  for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+  {
+    if ( flip_min[l_page] < front_min[l_page] )
+    {
+      front_min[l_page] = flip_min[l_page];
+    }
+    if ( flip_max[l_page] > front_max[l_page] )
+    {
+      front_max[l_page] = flip_max[l_page];
+    }
+  }
+  return;
+}
+
+
+/*
+ * front_dirty; internal function which returns true if any of the front
+ *              buffer still needs sending.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::front_dirty( void )
+{
+  for ( uint8_t l_page = 0; l_page < pagesize; l_page++ )
+  {
+    if ( front_min[l_page] <= front_max[l_page] )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/*
+ * clear_dirty; internal function to mark the front buffer as clean, once it
+ *              has been sent to the display.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::clear_dirty( void )
+{
+  for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+  {
+    front_min[l_page] = 0xFF;
+    front_max[l_page] = 0;
+  }
+  return;
+}
+
+
+/*
+ * enable_async; sets the transport up for render_async, for frames of this
+ *               display's size; the arguments are passed on to the
+ *               transport's enable_async (for I2CDMATransport, an optional
+ *               DMA channel and staging buffer). Returns false if that fails.
+ */
+
+template<class Transport>
+template<typename... Args>
+bool pal::SSD1306Driver<Transport>::enable_async( Args... p_args )
+{
+  return transport.enable_async( screen_buffer_sz - 1, p_args... );
+}
+
+
+/*
+ * render_async; starts sending the current screen buffer to the display,
+ *               returning immediately if the transport can do that in the
+ *               background. The buffer is staged before this returns, so
+ *               drawing can carry on while the frame is sent. The optional
+ *               callback is called (in IRQ context) when the transfer
+ *               completes. If it fails, the next render sends everything.
+ *               With a mailbox, it's the newest published frame that is
+ *               sent; if there isn't one, only what's left of the last is,
+ *               if anything. On core1, this is render, with the callback
+ *               called on core1 once the frame is sent, or straight away
+ *               with FRAME_DROPPED if the frame policy drops it.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::render_async( ssd1306_frame_cb_t p_callback, void *p_context )
+{
+  uint8_t l_trailer[1];
+  size_t  l_trailer_length;
+  uint8_t l_index;
+  bool    l_result, l_sent;
+#if SSD1306_STATS
+  uint64_t l_start = time_us_64();
+  size_t   l_dirty = 0;
+#endif
+
+  SSD1306_STAT( stats_latch_pixels() );
+
+  /* Rendering on core1 is asynchronous anyway. */
+  if ( core1_mode )
+  {
+    return post_frame( p_callback, p_context );
+  }
+
+  /* Let any previous asynchronous render finish (and catch up, if it */
+  /* failed) before we reuse its callback details.                    */
+  check_async();
+
+  /* Pick up the newest mailbox frame; without one, there may be nothing */
+  /* to send beyond any held commands, and that's done here and now.     */
+  if ( mailbox_mode )
+  {
+    if ( mailbox.acquire( &l_index ) )
+    {
+      front_buffer = mailbox_buffers[l_index];
+    }
+    else if ( !front_dirty() )
+    {
+      l_result = flush_cmds();
+      if ( p_callback != nullptr )
+      {
+        p_callback( l_result ? FRAME_SENT : FRAME_FAILED, p_context );
+      }
+      return l_result;
+    }
+  }
+
+  /* Send the draw commands, setting the page and column ranges. */
+  queue_cmd( PAGEADDR, page_offset, page_offset + pagesize - 1 );
+  queue_cmd( COLUMNADDR, 0, width - 1 );
+  l_result = flush_cmds();
+
+  /* When page flipping, follow the frame with the command to show it, so */
+  /* the flip happens the moment the frame is complete.                   */
+  l_trailer_length = 0;
+  if ( page_flip )
+  {
+    l_trailer[l_trailer_length++] = SETSTARTLINE | ( page_offset * 8 );
+    page_offset = page_offset ? 0 : pagesize;
+  }
+
+  /* The whole frame is being sent, so nothing is dirty any more; the */
+  /* drawing side's dirty areas aren't ours to take with a mailbox.    */
+  if ( !double_buffered && !mailbox_mode )
+  {
+    latch_dirty();
+  }
+  if ( page_flip )
+  {
+    merge_flip_dirty();
+  }
+#if SSD1306_STATS
+  for ( uint8_t l_page = 0; l_page < pagesize; l_page++ )
+  {
+    if ( front_min[l_page] <= front_max[l_page] )
+    {
+      l_dirty += front_max[l_page] - front_min[l_page] + 1;
+    }
+  }
+#endif
+  clear_dirty();
+
+  /* The shadow is brought up to date now, as the frame is sent from a */
+  /* staged copy; if the transfer fails, it's thrown away again.       */
+  if ( render_mode == RENDER_SHADOW )
+  {
+    memcpy( shadow_buffer, front_buffer + 1, screen_buffer_sz - 1 );
+    shadow_valid = true;
+  }
+
+  /* And hand it over to the transport, which reports back to async_done. */
+  async_cb = p_callback;
+  async_cb_context = p_context;
+  l_sent = transport.write_data_async( front_buffer + 1, screen_buffer_sz - 1,
+                                      l_trailer, l_trailer_length, async_done, this );
+  SSD1306_STAT( stats_write( screen_buffer_sz - 1 + l_trailer_length, l_sent ) );
+  SSD1306_STAT( stats_frame( l_start, l_dirty ) );
+  if ( !l_result )
+  {
+    async_failed = true;
+  }
+  return l_sent && l_result;
+}
+
+
+/*
+ * async_done; static function, called by the transport (usually in IRQ
+ *             context) when an asynchronous render completes. A failure is
+ *             only noted here, and dealt with by the next render; the
+ *             caller's callback is told how the frame fared.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::async_done( bool p_success, void *p_context )
+{
+  SSD1306Driver<Transport> *l_display = (SSD1306Driver<Transport> *)p_context;
+
+  if ( !p_success )
+  {
+    l_display->async_failed = true;
+  }
+  if ( l_display->async_cb != nullptr )
+  {
+    l_display->async_cb( p_success ? FRAME_SENT : FRAME_FAILED, l_display->async_cb_context );
+  }
+  return;
+}
+
+
+/*
+ * check_async; internal function which waits for any asynchronous render to
+ *              finish and, if it failed, marks everything as needing to be
+ *              sent again; there's no knowing how much of the frame arrived,
+ *              so neither the dirty ranges nor the shadow can be trusted.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::check_async( void )
+{
+  while ( transport.is_busy() )
+  {
+    tight_loop_contents();
+  }
+
+  if ( !async_failed )
+  {
+    return;
+  }
+  async_failed = false;
+
+  for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+  {
+    front_min[l_page] = flip_min[l_page] = 0;
+    front_max[l_page] = flip_max[l_page] = width - 1;
+  }
+  shadow_valid = false;
+  return;
+}
+
+
+/*
+ * is_render_busy; returns true while an asynchronous render is in flight.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::is_render_busy( void )
+{
+  return transport.is_busy();
+}
+
+
+/*
+ * begin_commands; starts gathering display commands; anything sent by queue
+ *                 or the various setters (set_contrast, set_invert and so on)
+ *                 is held until commit, and then sent in a single write. So
+ *                 a batch can be at most SSD1306_CMD_BUFFER_SZ - 1 bytes;
+ *                 queue refuses anything that would take it over that.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::begin_commands( void )
+{
+  wait_for_core1();
+  cmd_batching = true;
+  return;
+}
+
+
+/*
+ * commit; sends the commands gathered since begin_commands. If with_render is
+ *         set, they are held and sent along with the next render instead, so
+ *         that the frame and its settings go out in one bus session; that
+ *         render sends them even if it has nothing else to send.
+ */
+
+template<class Transport>
+bool pal::SSD1306Driver<Transport>::commit( bool p_with_render )
+{
+  wait_for_core1();
+  cmd_batching = false;
+
+  /* Leaving the commands queued means render will pick them up. */
+  if ( p_with_render )
+  {
+    return true;
+  }
+  return flush_cmds();
+}
+
+
+/*
+ * set_contrast; the contrast of the display varies from 0 to 255. Note that 
+ *               this is a display-wide setting.
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::set_contrast( uint8_t p_contrast )
+{
+  wait_for_core1();
+  write_cmd( SETCONTRAST, p_contrast );
+  return;
+}
+
+
+/*
+ * set_invert; sets the display to be normal (false) or inverted (true)
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::set_invert( bool p_invert )
+{
+  wait_for_core1();
+
+  /* Simple boolean choice. */
+  if ( p_invert )
+  {
+    write_cmd( INVERTDISPLAY );
+  }
+  else
+  {
+    write_cmd( NORMALDISPLAY );
+  }
+
+  /* And we're done. */
+  return;
+}
+
+
+/*
+ * queue; adds a raw command, with any number of argument bytes, to the
+ *        commands being gathered since begin_commands(). Returns false if
+ *        it won't fit in the batch, in which case it isn't added at all.
+ */
+
+template<class Transport>
+template<typename... Args>
+bool pal::SSD1306Driver<Transport>::queue( ssd1306_cmd_t p_cmd, Args... p_args )
+{
+  const uint8_t l_bytes[] = { (uint8_t)p_cmd, (uint8_t)p_args... };
+
+  wait_for_core1();
+  return queue_bytes( l_bytes, sizeof( l_bytes ) );
+}
+
+
+/*
+ * core1_frame; static function, run on core1, which renders a frame for
+ *              the display it's given, and then calls the callback posted
+ *              with it (if any).
+ */
+
+template<class Transport>
+void pal::SSD1306Driver<Transport>::core1_frame( SSD1306Canvas *p_display )
+{
+  SSD1306Driver<Transport> *l_display = static_cast<SSD1306Driver<Transport> *>( p_display );
+  bool                      l_result;
+
+  l_result = l_display->render_frame();
+  if ( l_display->async_cb != nullptr )
+  {
+    l_display->async_cb( l_result ? FRAME_SENT : FRAME_FAILED, l_display->async_cb_context );
+  }
+  return;
+}
+
+#endif /* PAL_SSD1306_DRIVER_H */
+
+/* End of file pal-ssd1306-driver.h */
@@ -0,0 +1,76 @@
+/*
+ * pal-ssd1306-font.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Describes a bitmap font for draw_char and draw_text. The fonts themselves
+ * live in fonts/, a header each; include the ones you use, and only those
+ * end up in flash.
+ *
+ * Glyphs are stored the way the screen buffer is laid out: column by column,
+ * left to right, with each column a byte per page of the glyph's height, top
+ * page first, and the top row of each page in bit 0. So a glyph can be drawn
+ * straight from the bitmap, with no conversion.
+ *
+ * Glyphs can also be run length packed, with SSD1306_FONT_RLE set; each is
+ * then a series of runs, each starting with a control byte. Below 0x80, it
+ * is followed by control + 1 bytes to copy as they are; otherwise, by one
+ * byte to repeat ( control & 0x7F ) + 2 times. Packed glyphs are unpacked
+ * as they are drawn, so they can be no more than SSD1306_FONT_MAX_UNPACKED
+ * bytes, and always have an entry in glyphs.
+ *
+ * The pal-ssd1306-fontc tool (in tools/) makes font headers from BDF and
+ * PSF fonts.
+ */
+
+#ifndef   PAL_SSD1306_FONT_H
+#define   PAL_SSD1306_FONT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Font flags. */
+#define SSD1306_FONT_RLE          0x01
+
+/* The most a packed glyph can unpack to; 32 columns of 64 rows, say. */
+#define SSD1306_FONT_MAX_UNPACKED 256
+
+namespace pal
+{
+  /* Where a glyph of a proportional (or packed) font starts in the       */
+  /* bitmap, and how wide it is; the advance is how far along the next    */
+  /* glyph goes.                                                          */
+  typedef struct
+  {
+    uint16_t offset;
+    uint8_t  width;
+    uint8_t  advance;
+  } ssd1306_glyph_t;
+
+
+  /*
+   * Font; a font covers the codepoints first to last, with anything outside
+   *       that drawn as the fallback. In a fixed width font (glyphs is null)
+   *       every glyph is width columns wide and advances the same, and the
+   *       glyphs follow each other in the bitmap; otherwise, each has its
+   *       own entry in glyphs. Flags are SSD1306_FONT_* bits.
+   */
+
+  struct Font
+  {
+    uint8_t                height;
+    uint8_t                first;
+    uint8_t                last;
+    uint8_t                fallback;
+    uint8_t                width;
+    uint8_t                advance;
+    const ssd1306_glyph_t *glyphs;
+    const uint8_t         *bitmap;
+    uint8_t                flags;
+  };
+}
+
+#endif /* PAL_SSD1306_FONT_H */
+
+/* End of file pal-ssd1306-font.h */
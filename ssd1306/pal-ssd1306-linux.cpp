@@ -0,0 +1,235 @@
+/*
+ * pal-ssd1306-linux.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A transport for driving an SSD1306 from Linux userspace, through the
+ * /dev/i2c-N interface.
+ */
+
+/* Header files. */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "pal-ssd1306-linux.h"
+
+
+/* Functions. */
+
+/*
+ * LinuxI2CTransport; constructor for a bus given by its device path (such as
+ *                    /dev/i2c-1), which is opened by begin.
+ */
+
+pal::LinuxI2CTransport::LinuxI2CTransport( const char *p_device, uint8_t p_address )
+{
+  device = p_device;
+  fd = -1;
+  owns_fd = false;
+  address = p_address;
+  pending_length = 0;
+  return;
+}
+
+
+/*
+ * LinuxI2CTransport; constructor for a bus that's already open; it remains
+ *                    the caller's to close.
+ */
+
+pal::LinuxI2CTransport::LinuxI2CTransport( int p_fd, uint8_t p_address )
+{
+  device = nullptr;
+  fd = p_fd;
+  owns_fd = false;
+  address = p_address;
+  pending_length = 0;
+  return;
+}
+
+
+/*
+ * LinuxI2CTransport; copy constructor; a descriptor we opened ourselves
+ *                    isn't shared, the copy will open its own.
+ */
+
+pal::LinuxI2CTransport::LinuxI2CTransport( const LinuxI2CTransport &p_other )
+{
+  device = p_other.device;
+  fd = p_other.owns_fd ? -1 : p_other.fd;
+  owns_fd = false;
+  address = p_other.address;
+  pending_length = 0;
+  return;
+}
+
+
+/*
+ * ~LinuxI2CTransport; destructor, which closes the bus if we opened it.
+ */
+
+pal::LinuxI2CTransport::~LinuxI2CTransport()
+{
+  if ( owns_fd && fd >= 0 )
+  {
+    close( fd );
+  }
+  fd = -1;
+  return;
+}
+
+
+/*
+ * LinuxI2CTransport::begin; opens the bus, if we were given a device path. If
+ *                           that fails, every write will report failure.
+ */
+
+void pal::LinuxI2CTransport::begin( void )
+{
+  if ( fd < 0 && device != nullptr )
+  {
+    fd = open( device, O_RDWR );
+    owns_fd = ( fd >= 0 );
+  }
+  return;
+}
+
+
+/*
+ * LinuxI2CTransport::transfer; internal function which sends any pending
+ *                              commands, a buffer behind the given control
+ *                              byte (borrowed from just in front of it) and
+ *                              any trailing commands, as a single I2C_RDWR
+ *                              ioctl. A trailer longer than a command batch
+ *                              is refused, rather than sent without it.
+ */
+
+bool pal::LinuxI2CTransport::transfer( uint8_t p_control, uint8_t *p_buffer, size_t p_length,
+                                       const uint8_t *p_trailer, size_t p_trailer_length )
+{
+  struct i2c_msg             l_msgs[3];
+  struct i2c_rdwr_ioctl_data l_request;
+  uint8_t                    l_trailer[SSD1306_CMD_BUFFER_SZ + 1];
+  uint8_t                    l_saved;
+  int                        l_result;
+
+  /* Without a bus, there's nothing we can do. */
+  if ( fd < 0 || p_trailer_length >= sizeof( l_trailer ) )
+  {
+    pending_length = 0;
+    return false;
+  }
+
+  /* Anything held back goes first. */
+  l_request.msgs = l_msgs;
+  l_request.nmsgs = 0;
+  if ( pending_length > 0 )
+  {
+    l_msgs[l_request.nmsgs].addr = address;
+    l_msgs[l_request.nmsgs].flags = 0;
+    l_msgs[l_request.nmsgs].len = pending_length;
+    l_msgs[l_request.nmsgs].buf = pending;
+    l_request.nmsgs++;
+  }
+
+  /* Then the buffer itself. */
+  l_saved = p_buffer[-1];
+  p_buffer[-1] = p_control;
+  l_msgs[l_request.nmsgs].addr = address;
+  l_msgs[l_request.nmsgs].flags = 0;
+  l_msgs[l_request.nmsgs].len = p_length + 1;
+  l_msgs[l_request.nmsgs].buf = p_buffer - 1;
+  l_request.nmsgs++;
+
+  /* And any trailing commands, which need a control byte of their own. */
+  if ( p_trailer_length > 0 )
+  {
+    l_trailer[0] = 0x00;
+    memcpy( l_trailer + 1, p_trailer, p_trailer_length );
+    l_msgs[l_request.nmsgs].addr = address;
+    l_msgs[l_request.nmsgs].flags = 0;
+    l_msgs[l_request.nmsgs].len = p_trailer_length + 1;
+    l_msgs[l_request.nmsgs].buf = l_trailer;
+    l_request.nmsgs++;
+  }
+
+  /* Send the lot, in one go. */
+  l_result = ioctl( fd, I2C_RDWR, &l_request );
+  p_buffer[-1] = l_saved;
+  pending_length = 0;
+  return ( l_result >= 0 );
+}
+
+
+/*
+ * LinuxI2CTransport::write_commands; sends command bytes. Held commands are
+ *                                    kept back to go out with the next write
+ *                                    (so any failure is reported by that
+ *                                    write, not this one).
+ */
+
+bool pal::LinuxI2CTransport::write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold )
+{
+  if ( p_hold && pending_length == 0 && p_length < sizeof( pending ) )
+  {
+    pending[0] = 0x00;
+    memcpy( pending + 1, p_cmds, p_length );
+    pending_length = p_length + 1;
+    return true;
+  }
+
+  return transfer( 0x00, p_cmds, p_length );
+}
+
+
+/*
+ * LinuxI2CTransport::write_data; sends screen data, behind a data control
+ *                                byte.
+ */
+
+bool pal::LinuxI2CTransport::write_data( uint8_t *p_data, size_t p_length )
+{
+  return transfer( 0x40, p_data, p_length );
+}
+
+
+/*
+ * LinuxI2CTransport::write_data_async; there's no background transfer here,
+ *                                      but the data and trailer do at least go
+ *                                      out in a single ioctl.
+ */
+
+bool pal::LinuxI2CTransport::write_data_async( const uint8_t *p_data, size_t p_length,
+                                               const uint8_t *p_trailer, size_t p_trailer_length,
+                                               ssd1306_render_cb_t p_callback, void *p_context )
+{
+  bool l_result;
+
+  /* The data is the caller's screen buffer, with room in front of it. */
+  l_result = transfer( 0x40, (uint8_t *)p_data, p_length, p_trailer, p_trailer_length );
+
+  if ( p_callback != nullptr )
+  {
+    p_callback( l_result, p_context );
+  }
+  return l_result;
+}
+
+
+/*
+ * LinuxI2CTransport::is_busy; blocking writes are never in flight.
+ */
+
+bool pal::LinuxI2CTransport::is_busy( void )
+{
+  return false;
+}
+
+
+/* End of file pal-ssd1306-linux.cpp */
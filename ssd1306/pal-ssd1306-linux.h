@@ -0,0 +1,62 @@
+/*
+ * pal-ssd1306-linux.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A transport for driving an SSD1306 from Linux userspace, through the
+ * /dev/i2c-N interface; only built off the Pico.
+ */
+
+#ifndef   PAL_SSD1306_LINUX_H
+#define   PAL_SSD1306_LINUX_H
+
+#include "pal-ssd1306.h"
+
+namespace pal
+{
+  /*
+   * LinuxI2CTransport; talks to the display with ioctl(I2C_RDWR), which sends
+   *                    a set of messages as one combined transaction. Held
+   *                    commands (the window set up ahead of a frame) are
+   *                    kept back, and go out in the same ioctl as the data
+   *                    that follows - so a frame is a single system call,
+   *                    with a repeated START between the messages, exactly
+   *                    as on the Pico. The bus can be given as a device path
+   *                    (opened in begin, and closed again when done) or an
+   *                    already open descriptor, which remains the caller's.
+   */
+
+  class LinuxI2CTransport
+  {
+  private:
+    const char *device;
+    int         fd;
+    bool        owns_fd;
+    uint8_t     address;
+
+    uint8_t     pending[SSD1306_CMD_BUFFER_SZ + 1];
+    size_t      pending_length;
+
+    bool transfer( uint8_t p_control, uint8_t *p_buffer, size_t p_length,
+                   const uint8_t *p_trailer = nullptr, size_t p_trailer_length = 0 );
+
+  public:
+    explicit LinuxI2CTransport( const char *p_device, uint8_t p_address = 0x3C );
+    explicit LinuxI2CTransport( int p_fd, uint8_t p_address = 0x3C );
+    LinuxI2CTransport( const LinuxI2CTransport &p_other );
+    ~LinuxI2CTransport();
+
+    void begin( void );
+    bool write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold );
+    bool write_data( uint8_t *p_data, size_t p_length );
+    bool write_data_async( const uint8_t *p_data, size_t p_length,
+                           const uint8_t *p_trailer, size_t p_trailer_length,
+                           ssd1306_render_cb_t p_callback, void *p_context );
+    bool is_busy( void );
+  };
+}
+
+#endif /* PAL_SSD1306_LINUX_H */
+
+/* End of file pal-ssd1306-linux.h */
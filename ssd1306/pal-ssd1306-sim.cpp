@@ -0,0 +1,627 @@
+/*
+ * pal-ssd1306-sim.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A software model of the SSD1306 controller, used as a transport; it
+ * interprets everything the driver sends just as the panel would, so that
+ * the result can be checked (or dumped as an image) with no panel attached.
+ */
+
+/* Header files. */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pal-ssd1306-sim.h"
+
+
+/* Constants. */
+
+#define SIM_RAM_ROWS 64
+
+
+/* Functions. */
+
+/*
+ * command_arguments; internal function returning how many argument bytes
+ *                    follow the given command byte.
+ */
+
+static uint8_t command_arguments( uint8_t p_cmd )
+{
+  switch( p_cmd )
+  {
+    case 0x20:      /* MEMORYMODE */
+    case 0x23:      /* Fade out and blinking */
+    case 0x81:      /* SETCONTRAST */
+    case 0x8D:      /* CHARGEPUMP */
+    case 0xA8:      /* SETMULTIPLEX */
+    case 0xD3:      /* SETDISPLAYOFFSET */
+    case 0xD5:      /* SETDISPLAYCLOCKDIV */
+    case 0xD6:      /* Zoom in */
+    case 0xD9:      /* SETPRECHARGE */
+    case 0xDA:      /* SETCOMPINS */
+    case 0xDB:      /* SETVCOMDETECT */
+      return 1;
+    case 0x21:      /* COLUMNADDR */
+    case 0x22:      /* PAGEADDR */
+    case 0xA3:      /* SET_VERTICAL_SCROLL_AREA */
+      return 2;
+    case 0x29:      /* VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL */
+    case 0x2A:      /* VERTICAL_AND_LEFT_HORIZONTAL_SCROLL */
+      return 5;
+    case 0x26:      /* RIGHT_HORIZONTAL_SCROLL */
+    case 0x27:      /* LEFT_HORIZONTAL_SCROLL */
+      return 6;
+  }
+  return 0;
+}
+
+
+/*
+ * SimulatorTransport; constructor, for a panel of the given size; the
+ *                     controller starts in its power-on reset state.
+ */
+
+pal::SimulatorTransport::SimulatorTransport( uint8_t p_width, uint8_t p_height )
+{
+  panel_width = ( p_width > SSD1306_SIM_COLUMNS ) ? SSD1306_SIM_COLUMNS : p_width;
+  panel_height = ( p_height > SIM_RAM_ROWS ) ? SIM_RAM_ROWS : p_height;
+  reset();
+  return;
+}
+
+
+/*
+ * SimulatorTransport::reset; returns the controller to its power-on reset
+ *                            state, as the RES# pin would. The real display
+ *                            RAM is left holding noise; ours is cleared.
+ */
+
+void pal::SimulatorTransport::reset( void )
+{
+  memset( ram, 0, sizeof( ram ) );
+
+  addressing_mode = 0x02;
+  column = 0;
+  column_start = 0;
+  column_end = SSD1306_SIM_COLUMNS - 1;
+  page = 0;
+  page_start = 0;
+  page_end = SSD1306_MAX_PAGES - 1;
+
+  start_line = 0;
+  display_offset = 0;
+  multiplex = SIM_RAM_ROWS;
+  contrast = 0x7F;
+  segment_remap = false;
+  com_reverse = false;
+  inverted = false;
+  all_on = false;
+  display_on = false;
+
+  scroll_active = false;
+  scroll_left = false;
+  scroll_vertical = false;
+  scroll_start_page = 0;
+  scroll_end_page = 0;
+  scroll_step = 0;
+  scroll_fixed_rows = 0;
+  scroll_rows = SIM_RAM_ROWS;
+  scroll_position = 0;
+
+  command_length = 0;
+  command_needed = 0;
+  reset_counts();
+  return;
+}
+
+
+/*
+ * SimulatorTransport::command_byte; internal function which collects a
+ *                                   command and its arguments (which may be
+ *                                   split across writes), executing it once
+ *                                   it's complete.
+ */
+
+void pal::SimulatorTransport::command_byte( uint8_t p_byte )
+{
+  if ( command_length == 0 )
+  {
+    command_needed = command_arguments( p_byte );
+  }
+  else
+  {
+    command_needed--;
+  }
+  command[command_length++] = p_byte;
+
+  if ( command_needed == 0 )
+  {
+    execute();
+    command_length = 0;
+  }
+  return;
+}
+
+
+/*
+ * SimulatorTransport::execute; internal function which applies a complete
+ *                              command to the controller state, noting if
+ *                              it changed nothing.
+ */
+
+void pal::SimulatorTransport::execute( void )
+{
+  uint8_t l_cmd = command[0];
+  uint8_t l_value;
+  bool    l_redundant = false;
+
+  sent.command_bytes += command_length;
+
+  /* The single byte commands with their argument in the low bits first. */
+  if ( l_cmd <= 0x0F )
+  {
+    l_value = ( column & 0xF0 ) | l_cmd;
+    l_redundant = ( l_value == column );
+    column = l_value;
+  }
+  else if ( l_cmd >= 0x10 && l_cmd <= 0x17 )
+  {
+    l_value = ( column & 0x0F ) | ( ( l_cmd & 0x07 ) << 4 );
+    l_redundant = ( l_value == column );
+    column = l_value;
+  }
+  else if ( l_cmd >= 0x40 && l_cmd <= 0x7F )
+  {
+    l_redundant = ( start_line == ( l_cmd & 0x3F ) );
+    start_line = l_cmd & 0x3F;
+  }
+  else if ( l_cmd >= 0xB0 && l_cmd <= 0xB7 )
+  {
+    l_redundant = ( page == ( l_cmd & 0x07 ) );
+    page = l_cmd & 0x07;
+  }
+  else
+  {
+    switch( l_cmd )
+    {
+      case 0x20:      /* MEMORYMODE; 3 is invalid, and behaves as page mode */
+        l_value = ( command[1] & 0x03 ) == 0x03 ? 0x02 : command[1] & 0x03;
+        l_redundant = ( addressing_mode == l_value );
+        addressing_mode = l_value;
+        break;
+      case 0x21:      /* COLUMNADDR; only redundant if already at its start */
+        l_redundant = ( column_start == ( command[1] & 0x7F ) && column_end == ( command[2] & 0x7F ) &&
+                        column == column_start );
+        column_start = command[1] & 0x7F;
+        column_end = command[2] & 0x7F;
+        column = column_start;
+        break;
+      case 0x22:      /* PAGEADDR; likewise */
+        l_redundant = ( page_start == ( command[1] & 0x07 ) && page_end == ( command[2] & 0x07 ) &&
+                        page == page_start );
+        page_start = command[1] & 0x07;
+        page_end = command[2] & 0x07;
+        page = page_start;
+        break;
+      case 0x26:      /* RIGHT_HORIZONTAL_SCROLL */
+      case 0x27:      /* LEFT_HORIZONTAL_SCROLL */
+        scroll_left = ( l_cmd == 0x27 );
+        scroll_vertical = false;
+        scroll_start_page = command[2] & 0x07;
+        scroll_end_page = command[4] & 0x07;
+        scroll_step = 0;
+        break;
+      case 0x29:      /* VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL */
+      case 0x2A:      /* VERTICAL_AND_LEFT_HORIZONTAL_SCROLL */
+        scroll_left = ( l_cmd == 0x2A );
+        scroll_vertical = true;
+        scroll_start_page = command[2] & 0x07;
+        scroll_end_page = command[4] & 0x07;
+        scroll_step = command[5] & 0x3F;
+        break;
+      case 0x2E:      /* DEACTIVATE_SCROLL */
+        l_redundant = !scroll_active;
+        scroll_active = false;
+        scroll_position = 0;
+        break;
+      case 0x2F:      /* ACTIVATE_SCROLL */
+        scroll_active = true;
+        scroll_position = 0;
+        break;
+      case 0x81:      /* SETCONTRAST */
+        l_redundant = ( contrast == command[1] );
+        contrast = command[1];
+        break;
+      case 0xA0:      /* SEGREMAP, off and on */
+      case 0xA1:
+        l_redundant = ( segment_remap == ( l_cmd == 0xA1 ) );
+        segment_remap = ( l_cmd == 0xA1 );
+        break;
+      case 0xA3:      /* SET_VERTICAL_SCROLL_AREA */
+        scroll_fixed_rows = command[1] & 0x3F;
+        scroll_rows = command[2] & 0x7F;
+        break;
+      case 0xA4:      /* DISPLAYALLON, resume from RAM and entire display on */
+      case 0xA5:
+        l_redundant = ( all_on == ( l_cmd == 0xA5 ) );
+        all_on = ( l_cmd == 0xA5 );
+        break;
+      case 0xA6:      /* NORMALDISPLAY */
+      case 0xA7:      /* INVERTDISPLAY */
+        l_redundant = ( inverted == ( l_cmd == 0xA7 ) );
+        inverted = ( l_cmd == 0xA7 );
+        break;
+      case 0xA8:      /* SETMULTIPLEX; ratios below 16 are invalid, and ignored */
+        if ( ( command[1] & 0x3F ) >= 15 )
+        {
+          l_redundant = ( multiplex == ( command[1] & 0x3F ) + 1 );
+          multiplex = ( command[1] & 0x3F ) + 1;
+        }
+        break;
+      case 0xAE:      /* DISPLAYOFF */
+      case 0xAF:      /* DISPLAYON */
+        l_redundant = ( display_on == ( l_cmd == 0xAF ) );
+        display_on = ( l_cmd == 0xAF );
+        break;
+      case 0xC0:      /* COMSCANINC */
+      case 0xC8:      /* COMSCANDEC */
+        l_redundant = ( com_reverse == ( l_cmd == 0xC8 ) );
+        com_reverse = ( l_cmd == 0xC8 );
+        break;
+      case 0xD3:      /* SETDISPLAYOFFSET */
+        l_redundant = ( display_offset == ( command[1] & 0x3F ) );
+        display_offset = command[1] & 0x3F;
+        break;
+    }
+  }
+
+  if ( l_redundant )
+  {
+    sent.redundant_command_bytes += command_length;
+  }
+  return;
+}
+
+
+/*
+ * SimulatorTransport::data_byte; internal function which writes a byte of
+ *                                screen data at the current address, and
+ *                                moves on as the addressing mode dictates.
+ *                                Returns true if the byte changed anything.
+ */
+
+bool pal::SimulatorTransport::data_byte( uint8_t p_byte )
+{
+  bool l_changed = ( ram[page][column] != p_byte );
+
+  ram[page][column] = p_byte;
+
+  switch( addressing_mode )
+  {
+    case 0x00:      /* Horizontal; along the columns, then down the pages */
+      if ( column >= column_end )
+      {
+        column = column_start;
+        page = ( page >= page_end ) ? page_start : page + 1;
+      }
+      else
+      {
+        column++;
+      }
+      break;
+    case 0x01:      /* Vertical; down the pages, then along the columns */
+      if ( page >= page_end )
+      {
+        page = page_start;
+        column = ( column >= column_end ) ? column_start : column + 1;
+      }
+      else
+      {
+        page++;
+      }
+      break;
+    default:        /* Page; along the columns, staying on the page */
+      column = ( column >= column_end ) ? column_start : column + 1;
+      break;
+  }
+  return l_changed;
+}
+
+
+/*
+ * SimulatorTransport::write_ram; internal function which writes a run of
+ *                                screen data, counting how much of it (and
+ *                                of each page it covers) changed nothing.
+ */
+
+void pal::SimulatorTransport::write_ram( const uint8_t *p_data, size_t p_length )
+{
+  uint8_t l_page;
+  bool    l_write_changed = false;
+  bool    l_page_changed = false;
+
+  if ( p_length == 0 )
+  {
+    return;
+  }
+
+  l_page = page;
+  for ( size_t l_index = 0; l_index < p_length; l_index++ )
+  {
+    /* A new page means the last one's part of the write is complete. */
+    if ( page != l_page )
+    {
+      sent.page_writes++;
+      sent.unchanged_page_writes += l_page_changed ? 0 : 1;
+      l_page_changed = false;
+      l_page = page;
+    }
+
+    if ( data_byte( p_data[l_index] ) )
+    {
+      l_write_changed = l_page_changed = true;
+    }
+    else
+    {
+      sent.unchanged_data_bytes++;
+    }
+  }
+  sent.page_writes++;
+  sent.unchanged_page_writes += l_page_changed ? 0 : 1;
+
+  sent.data_bytes += p_length;
+  sent.data_writes++;
+  sent.unchanged_data_writes += l_write_changed ? 0 : 1;
+  return;
+}
+
+
+/*
+ * SimulatorTransport::begin; nothing to set up.
+ */
+
+void pal::SimulatorTransport::begin( void )
+{
+  return;
+}
+
+
+/*
+ * SimulatorTransport::write_commands; interprets command bytes; the hold
+ *                                     flag makes no difference here.
+ */
+
+bool pal::SimulatorTransport::write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold )
+{
+  for ( size_t l_index = 0; l_index < p_length; l_index++ )
+  {
+    command_byte( p_cmds[l_index] );
+  }
+  return true;
+}
+
+
+/*
+ * SimulatorTransport::write_data; writes screen data into the display RAM.
+ */
+
+bool pal::SimulatorTransport::write_data( uint8_t *p_data, size_t p_length )
+{
+  write_ram( p_data, p_length );
+  return true;
+}
+
+
+/*
+ * SimulatorTransport::write_data_async; as write_data, followed by the
+ *                                       trailing commands; it's all done
+ *                                       before this returns.
+ */
+
+bool pal::SimulatorTransport::write_data_async( const uint8_t *p_data, size_t p_length,
+                                                const uint8_t *p_trailer, size_t p_trailer_length,
+                                                ssd1306_render_cb_t p_callback, void *p_context )
+{
+  write_ram( p_data, p_length );
+  for ( size_t l_index = 0; l_index < p_trailer_length; l_index++ )
+  {
+    command_byte( p_trailer[l_index] );
+  }
+
+  if ( p_callback != nullptr )
+  {
+    p_callback( true, p_context );
+  }
+  return true;
+}
+
+
+/*
+ * SimulatorTransport::is_busy; nothing is ever in flight.
+ */
+
+bool pal::SimulatorTransport::is_busy( void )
+{
+  return false;
+}
+
+
+/*
+ * SimulatorTransport::advance_scroll; moves any active scroll on by the
+ *                                     given number of steps. The real
+ *                                     controller takes a step every few
+ *                                     frames (as set by the scroll command);
+ *                                     here, it's up to the caller. As on the
+ *                                     real thing, horizontal scrolling moves
+ *                                     the contents of the display RAM.
+ */
+
+void pal::SimulatorTransport::advance_scroll( uint16_t p_steps )
+{
+  uint8_t l_saved;
+
+  if ( !scroll_active || scroll_start_page > scroll_end_page )
+  {
+    return;
+  }
+
+  while( p_steps-- > 0 )
+  {
+    /* Rotate the scrolled pages by a column. */
+    for ( uint8_t l_page = scroll_start_page; l_page <= scroll_end_page; l_page++ )
+    {
+      if ( scroll_left )
+      {
+        l_saved = ram[l_page][0];
+        memmove( &ram[l_page][0], &ram[l_page][1], SSD1306_SIM_COLUMNS - 1 );
+        ram[l_page][SSD1306_SIM_COLUMNS - 1] = l_saved;
+      }
+      else
+      {
+        l_saved = ram[l_page][SSD1306_SIM_COLUMNS - 1];
+        memmove( &ram[l_page][1], &ram[l_page][0], SSD1306_SIM_COLUMNS - 1 );
+        ram[l_page][0] = l_saved;
+      }
+    }
+
+    /* And move the vertical scroll area on, if it's scrolling. */
+    if ( scroll_vertical && scroll_rows > 0 )
+    {
+      scroll_position = ( scroll_position + scroll_step ) % scroll_rows;
+    }
+  }
+  return;
+}
+
+
+/*
+ * SimulatorTransport::ram_byte; returns a byte of the display RAM.
+ */
+
+uint8_t pal::SimulatorTransport::ram_byte( uint8_t p_page, uint8_t p_column )
+{
+  if ( p_page >= SSD1306_MAX_PAGES || p_column >= SSD1306_SIM_COLUMNS )
+  {
+    return 0;
+  }
+  return ram[p_page][p_column];
+}
+
+
+/*
+ * SimulatorTransport::get_pixel; returns true if the given pixel of the
+ *                                panel is lit, taking into account the
+ *                                multiplex ratio, start line, display
+ *                                offset, vertical scrolling, remapping and
+ *                                all the display modes.
+ */
+
+bool pal::SimulatorTransport::get_pixel( uint8_t p_x, uint8_t p_y )
+{
+  uint8_t l_row, l_column;
+  bool    l_lit;
+
+  /* Rows beyond the multiplex ratio aren't driven at all. */
+  if ( p_x >= panel_width || p_y >= panel_height || p_y >= multiplex || !display_on )
+  {
+    return false;
+  }
+
+  if ( all_on )
+  {
+    l_lit = true;
+  }
+  else
+  {
+    /* Work back from the panel row to the row of display RAM shown there. */
+    l_row = com_reverse ? p_y : multiplex - 1 - p_y;
+    if ( scroll_active && scroll_vertical && scroll_rows > 0 &&
+         l_row >= scroll_fixed_rows && l_row < scroll_fixed_rows + scroll_rows )
+    {
+      l_row = scroll_fixed_rows + ( ( l_row - scroll_fixed_rows + scroll_position ) % scroll_rows );
+    }
+    l_row = ( l_row + start_line + display_offset ) % SIM_RAM_ROWS;
+
+    l_column = segment_remap ? p_x : panel_width - 1 - p_x;
+    l_lit = ( ram[l_row >> 3][l_column] & ( 0x01 << ( l_row & 0x07 ) ) ) != 0;
+  }
+
+  return l_lit != inverted;
+}
+
+
+/*
+ * SimulatorTransport::get_contrast; returns the contrast last set.
+ */
+
+uint8_t pal::SimulatorTransport::get_contrast( void )
+{
+  return contrast;
+}
+
+
+/*
+ * SimulatorTransport::write_pbm; saves what the panel is showing as a
+ *                                binary PBM image, with lit pixels white
+ *                                on black, as they'd look.
+ */
+
+bool pal::SimulatorTransport::write_pbm( const char *p_filename )
+{
+  FILE    *l_file;
+  uint8_t  l_line[( SSD1306_SIM_COLUMNS + 7 ) / 8];
+  size_t   l_line_length = ( panel_width + 7 ) / 8;
+  bool     l_result;
+
+  l_file = fopen( p_filename, "wb" );
+  if ( l_file == nullptr )
+  {
+    return false;
+  }
+
+  /* PBM has 1 for black, most significant bit leftmost. */
+  l_result = fprintf( l_file, "P4\n%u %u\n", panel_width, panel_height ) > 0;
+  for ( uint8_t l_y = 0; l_result && l_y < panel_height; l_y++ )
+  {
+    memset( l_line, 0, sizeof( l_line ) );
+    for ( uint8_t l_x = 0; l_x < panel_width; l_x++ )
+    {
+      if ( !get_pixel( l_x, l_y ) )
+      {
+        l_line[l_x >> 3] |= 0x80 >> ( l_x & 0x07 );
+      }
+    }
+    l_result = fwrite( l_line, 1, l_line_length, l_file ) == l_line_length;
+  }
+
+  return ( fclose( l_file ) == 0 ) && l_result;
+}
+
+
+/*
+ * SimulatorTransport::counts; returns what's been sent since the counts were
+ *                             last reset.
+ */
+
+const pal::ssd1306_sim_counts_t *pal::SimulatorTransport::counts( void )
+{
+  return &sent;
+}
+
+
+/*
+ * SimulatorTransport::reset_counts; zeroes the counts.
+ */
+
+void pal::SimulatorTransport::reset_counts( void )
+{
+  memset( &sent, 0, sizeof( sent ) );
+  return;
+}
+
+
+/* End of file pal-ssd1306-sim.cpp */
@@ -0,0 +1,124 @@
+/*
+ * pal-ssd1306-sim.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A software model of the SSD1306 controller, used as a transport; it
+ * interprets everything the driver sends just as the panel would, so that
+ * the result can be checked (or dumped as an image) with no panel attached.
+ */
+
+#ifndef   PAL_SSD1306_SIM_H
+#define   PAL_SSD1306_SIM_H
+
+#include "pal-ssd1306.h"
+
+/* The controller has 128 columns of display RAM, whatever the panel has. */
+#define SSD1306_SIM_COLUMNS 128
+
+namespace pal
+{
+  /* What the simulator has been sent, and how much of it had no effect; a */
+  /* page write is the part of a data write that falls on a single page.   */
+  typedef struct
+  {
+    size_t command_bytes;
+    size_t redundant_command_bytes;
+    size_t data_bytes;
+    size_t unchanged_data_bytes;
+    size_t data_writes;
+    size_t unchanged_data_writes;
+    size_t page_writes;
+    size_t unchanged_page_writes;
+  } ssd1306_sim_counts_t;
+
+
+  /*
+   * SimulatorTransport; models the display RAM (GDDRAM) and the commands
+   *                     which write to it or change how it's shown: the
+   *                     addressing modes and windows, start line, display
+   *                     offset and multiplex ratio, segment and COM scan
+   *                     remapping, inversion, entire display on, display
+   *                     on/off and scrolling. Commands it doesn't model
+   *                     (clocks, charge pump, precharge and so on) are
+   *                     parsed and ignored. The panel is assumed to be wired
+   *                     like the common modules, which appear the right way
+   *                     up with SEGREMAP and COMSCANDEC set. It also
+   *                     counts what it's sent which changes nothing - data
+   *                     the display RAM already holds, and commands which
+   *                     set what's already set.
+   */
+
+  class SimulatorTransport
+  {
+  private:
+    uint8_t  panel_width;
+    uint8_t  panel_height;
+    uint8_t  ram[SSD1306_MAX_PAGES][SSD1306_SIM_COLUMNS];
+
+    uint8_t  addressing_mode;
+    uint8_t  column;
+    uint8_t  column_start;
+    uint8_t  column_end;
+    uint8_t  page;
+    uint8_t  page_start;
+    uint8_t  page_end;
+
+    uint8_t  start_line;
+    uint8_t  display_offset;
+    uint8_t  multiplex;
+    uint8_t  contrast;
+    bool     segment_remap;
+    bool     com_reverse;
+    bool     inverted;
+    bool     all_on;
+    bool     display_on;
+
+    bool     scroll_active;
+    bool     scroll_left;
+    bool     scroll_vertical;
+    uint8_t  scroll_start_page;
+    uint8_t  scroll_end_page;
+    uint8_t  scroll_step;
+    uint8_t  scroll_fixed_rows;
+    uint8_t  scroll_rows;
+    uint8_t  scroll_position;
+
+    uint8_t  command[8];
+    uint8_t  command_length;
+    uint8_t  command_needed;
+
+    ssd1306_sim_counts_t sent;
+
+    void command_byte( uint8_t p_byte );
+    void execute( void );
+    bool data_byte( uint8_t p_byte );
+    void write_ram( const uint8_t *p_data, size_t p_length );
+
+  public:
+    SimulatorTransport( uint8_t p_width = 128, uint8_t p_height = 64 );
+
+    void begin( void );
+    bool write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold );
+    bool write_data( uint8_t *p_data, size_t p_length );
+    bool write_data_async( const uint8_t *p_data, size_t p_length,
+                           const uint8_t *p_trailer, size_t p_trailer_length,
+                           ssd1306_render_cb_t p_callback, void *p_context );
+    bool is_busy( void );
+
+    void    reset( void );
+    void    advance_scroll( uint16_t p_steps = 1 );
+    uint8_t ram_byte( uint8_t p_page, uint8_t p_column );
+    bool    get_pixel( uint8_t p_x, uint8_t p_y );
+    uint8_t get_contrast( void );
+    bool    write_pbm( const char *p_filename );
+
+    const ssd1306_sim_counts_t *counts( void );
+    void                        reset_counts( void );
+  };
+}
+
+#endif /* PAL_SSD1306_SIM_H */
+
+/* End of file pal-ssd1306-sim.h */
@@ -0,0 +1,192 @@
+/*
+ * pal-ssd1306-timing.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A model of how long the I2C bus takes to carry what the driver sends,
+ * for predicting frame times and rates without any hardware; feed it the
+ * transactions recorded by MockTransport.
+ */
+
+/* Header files. */
+
+#include "pal-ssd1306-timing.h"
+
+
+/* Functions. */
+
+/*
+ * I2CTimingModel; constructor, for a bus running at the given clock. The bus
+ *                 free time is the specification's minimum for the mode
+ *                 that clock falls in.
+ */
+
+pal::I2CTimingModel::I2CTimingModel( uint32_t p_clock_hz )
+{
+  clock_hz = ( p_clock_hz > 0 ) ? p_clock_hz : 400000;
+  if ( clock_hz <= 100000 )
+  {
+    bus_free_ns = 4700;
+  }
+  else if ( clock_hz <= 400000 )
+  {
+    bus_free_ns = 1300;
+  }
+  else
+  {
+    bus_free_ns = 500;
+  }
+  gap_ns = 0;
+  reset();
+  return;
+}
+
+
+/*
+ * I2CTimingModel::set_bus_free_time; overrides the idle time needed between
+ *                                    a STOP and the next START.
+ */
+
+void pal::I2CTimingModel::set_bus_free_time( uint32_t p_ns )
+{
+  bus_free_ns = p_ns;
+  return;
+}
+
+
+/*
+ * I2CTimingModel::set_gap; sets the time the CPU takes between transactions,
+ *                          over and above what the bus needs.
+ */
+
+void pal::I2CTimingModel::set_gap( uint32_t p_ns )
+{
+  gap_ns = p_ns;
+  return;
+}
+
+
+/*
+ * I2CTimingModel::reset; forgets everything added so far.
+ */
+
+void pal::I2CTimingModel::reset( void )
+{
+  totals.transactions = 0;
+  totals.payload_bytes = 0;
+  totals.wire_bytes = 0;
+  totals.bus_clocks = 0;
+  totals.duration_ns = 0;
+  return;
+}
+
+
+/*
+ * I2CTimingModel::add; adds a single transaction of the given payload; the
+ *                      address and control bytes are added to it here.
+ */
+
+void pal::I2CTimingModel::add( bool p_hold, size_t p_length )
+{
+  uint64_t l_clocks;
+
+  /* START, then nine clocks a byte, then STOP - unless we're holding on. */
+  l_clocks = 1 + ( 9 * ( p_length + 2 ) ) + ( p_hold ? 0 : 1 );
+
+  totals.transactions++;
+  totals.payload_bytes += p_length;
+  totals.wire_bytes += p_length + 2;
+  totals.bus_clocks += l_clocks;
+  totals.duration_ns += ( ( l_clocks * 1000000000 ) / clock_hz ) + gap_ns + ( p_hold ? 0 : bus_free_ns );
+  return;
+}
+
+
+/*
+ * I2CTimingModel::add; adds a transaction recorded by the mock transport.
+ */
+
+void pal::I2CTimingModel::add( const ssd1306_transaction_t *p_transaction )
+{
+  if ( p_transaction != nullptr )
+  {
+    add( p_transaction->hold, p_transaction->length );
+  }
+  return;
+}
+
+
+/*
+ * I2CTimingModel::add; adds everything the mock transport has recorded since
+ *                      it was last reset. Transactions beyond the end of its
+ *                      log are still counted, but as we can't know their
+ *                      sizes their bytes are shared out evenly and they're
+ *                      assumed not to be held; false is returned if that
+ *                      estimate had to be made.
+ */
+
+bool pal::I2CTimingModel::add( MockTransport *p_mock )
+{
+  size_t l_logged_bytes = 0;
+  size_t l_missing, l_missing_bytes;
+
+  for ( size_t l_index = 0; l_index < p_mock->count(); l_index++ )
+  {
+    add( p_mock->transaction( l_index ) );
+    l_logged_bytes += p_mock->transaction( l_index )->length;
+  }
+
+  /* Anything which didn't fit in the log. */
+  l_missing = p_mock->transactions_sent() - p_mock->count();
+  if ( l_missing == 0 )
+  {
+    return true;
+  }
+  l_missing_bytes = p_mock->bytes_sent() - l_logged_bytes;
+  for ( size_t l_index = 0; l_index < l_missing; l_index++ )
+  {
+    add( false, ( l_missing_bytes / l_missing ) + ( l_index < ( l_missing_bytes % l_missing ) ? 1 : 0 ) );
+  }
+  return false;
+}
+
+
+/*
+ * I2CTimingModel::timing; returns the totals for everything added so far.
+ */
+
+const pal::ssd1306_bus_timing_t *pal::I2CTimingModel::timing( void )
+{
+  return &totals;
+}
+
+
+/*
+ * I2CTimingModel::max_fps; returns how many times a second what's been
+ *                          added could be sent, if the bus did nothing else.
+ */
+
+float pal::I2CTimingModel::max_fps( void )
+{
+  if ( totals.duration_ns == 0 )
+  {
+    return 0.0f;
+  }
+  return 1.0e9f / totals.duration_ns;
+}
+
+
+/*
+ * I2CTimingModel::utilisation; returns the fraction of the bus's time taken
+ *                              up by sending what's been added at the given
+ *                              rate; anything over 1.0 won't fit.
+ */
+
+float pal::I2CTimingModel::utilisation( float p_fps )
+{
+  return ( totals.duration_ns * p_fps ) / 1.0e9f;
+}
+
+
+/* End of file pal-ssd1306-timing.cpp */
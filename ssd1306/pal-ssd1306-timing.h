@@ -0,0 +1,69 @@
+/*
+ * pal-ssd1306-timing.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A model of how long the I2C bus takes to carry what the driver sends,
+ * for predicting frame times and rates without any hardware; feed it the
+ * transactions recorded by MockTransport.
+ */
+
+#ifndef   PAL_SSD1306_TIMING_H
+#define   PAL_SSD1306_TIMING_H
+
+#include "pal-ssd1306-transport.h"
+
+namespace pal
+{
+  /* The predicted cost of a set of transactions. */
+  typedef struct
+  {
+    size_t   transactions;
+    size_t   payload_bytes;
+    size_t   wire_bytes;
+    uint64_t bus_clocks;
+    uint64_t duration_ns;
+  } ssd1306_bus_timing_t;
+
+
+  /*
+   * I2CTimingModel; counts the clocks each transaction takes on the bus:
+   *                 nine per byte (eight bits and the ACK) for the address,
+   *                 the control byte and the payload, and one each for the
+   *                 START (or repeated START) and STOP. Between a STOP and
+   *                 the next START the bus must also sit idle for the bus
+   *                 free time, tBUF, which for the standard modes is fixed
+   *                 by the I2C specification. A held transaction ends in a
+   *                 repeated START instead, so it saves both. Any time the
+   *                 CPU spends between transactions can be added as a gap.
+   */
+
+  class I2CTimingModel
+  {
+  private:
+    uint32_t             clock_hz;
+    uint32_t             bus_free_ns;
+    uint32_t             gap_ns;
+    ssd1306_bus_timing_t totals;
+
+  public:
+    I2CTimingModel( uint32_t p_clock_hz = 400000 );
+
+    void set_bus_free_time( uint32_t p_ns );
+    void set_gap( uint32_t p_ns );
+
+    void reset( void );
+    void add( bool p_hold, size_t p_length );
+    void add( const ssd1306_transaction_t *p_transaction );
+    bool add( MockTransport *p_mock );
+
+    const ssd1306_bus_timing_t *timing( void );
+    float max_fps( void );
+    float utilisation( float p_fps );
+  };
+}
+
+#endif /* PAL_SSD1306_TIMING_H */
+
+/* End of file pal-ssd1306-timing.h */
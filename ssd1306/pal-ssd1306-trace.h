@@ -0,0 +1,247 @@
+/*
+ * pal-ssd1306-trace.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A transport wrapper which records everything sent to the display as a
+ * compact binary trace, for replaying and analysing later (see the
+ * pal-ssd1306-replay tool).
+ *
+ * A trace starts with the four bytes "SSDT" and a version byte, followed by
+ * a record for each write:
+ *
+ *   uint8_t  flags     SSD1306_TRACE_* bits
+ *   varint   delta     microseconds since the previous record
+ *   varint   length    of the payload
+ *   uint8_t  payload[length]
+ *
+ * where a varint is little-endian base 128, seven bits to a byte with the
+ * top bit set on all but the last. The trailing commands of an asynchronous
+ * write follow its data as a record of their own, with a zero delta.
+ */
+
+#ifndef   PAL_SSD1306_TRACE_H
+#define   PAL_SSD1306_TRACE_H
+
+#include <pico/stdlib.h>
+
+#include "pal-ssd1306-transport.h"
+
+#define SSD1306_TRACE_VERSION 1
+
+/* Record flags. */
+#define SSD1306_TRACE_DATA    0x01
+#define SSD1306_TRACE_HOLD    0x02
+#define SSD1306_TRACE_ASYNC   0x04
+#define SSD1306_TRACE_FAILED  0x08
+
+namespace pal
+{
+  /* Where the trace goes; called with each piece of it, in order. */
+  typedef void (*ssd1306_trace_sink_t)( const uint8_t *p_bytes, size_t p_length, void *p_context );
+
+
+  /*
+   * RecordingTransport; passes everything through to the transport it
+   *                     wraps, and hands a record of each write to the sink.
+   *                     The sink is called in line with the write, so it
+   *                     should be quick - appending to a buffer, say.
+   */
+
+  template<class Inner>
+  class RecordingTransport
+  {
+  private:
+    Inner                 inner;
+    ssd1306_trace_sink_t  sink;
+    void                 *sink_context;
+    uint64_t              last_us;
+
+    void record( uint8_t p_flags, uint64_t p_time, const uint8_t *p_bytes, size_t p_length );
+
+  public:
+    RecordingTransport( const Inner &p_inner, ssd1306_trace_sink_t p_sink, void *p_context = nullptr );
+
+    Inner *get_inner( void ) { return &inner; }
+
+    template<typename... Args> bool enable_async( Args... p_args );
+
+    void begin( void );
+    bool write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold );
+    bool write_data( uint8_t *p_data, size_t p_length );
+    bool write_data_async( const uint8_t *p_data, size_t p_length,
+                           const uint8_t *p_trailer, size_t p_trailer_length,
+                           ssd1306_render_cb_t p_callback, void *p_context );
+    bool is_busy( void );
+  };
+}
+
+
+/* Functions. */
+
+/*
+ * RecordingTransport; constructor, wrapping a copy of the given transport.
+ */
+
+template<class Inner>
+pal::RecordingTransport<Inner>::RecordingTransport( const Inner &p_inner, ssd1306_trace_sink_t p_sink, void *p_context )
+  : inner( p_inner )
+{
+  sink = p_sink;
+  sink_context = p_context;
+  last_us = 0;
+  return;
+}
+
+
+/*
+ * RecordingTransport::record; internal function which encodes a record and
+ *                             hands it to the sink.
+ */
+
+template<class Inner>
+void pal::RecordingTransport<Inner>::record( uint8_t p_flags, uint64_t p_time, const uint8_t *p_bytes, size_t p_length )
+{
+  uint8_t  l_header[1 + 10 + 10];
+  size_t   l_header_length = 0;
+  uint64_t l_values[2];
+
+  if ( sink == nullptr )
+  {
+    return;
+  }
+
+  /* The flags, then the time delta and the length as varints. */
+  l_header[l_header_length++] = p_flags;
+  l_values[0] = p_time - last_us;
+  l_values[1] = p_length;
+  for ( uint64_t l_value : l_values )
+  {
+    while ( l_value >= 0x80 )
+    {
+      l_header[l_header_length++] = ( l_value & 0x7F ) | 0x80;
+      l_value >>= 7;
+    }
+    l_header[l_header_length++] = l_value;
+  }
+  last_us = p_time;
+
+  sink( l_header, l_header_length, sink_context );
+  if ( p_length > 0 )
+  {
+    sink( p_bytes, p_length, sink_context );
+  }
+  return;
+}
+
+
+/*
+ * RecordingTransport::enable_async; passed straight through to the wrapped
+ *                                   transport.
+ */
+
+template<class Inner>
+template<typename... Args>
+bool pal::RecordingTransport<Inner>::enable_async( Args... p_args )
+{
+  return inner.enable_async( p_args... );
+}
+
+
+/*
+ * RecordingTransport::begin; starts the trace, then the wrapped transport.
+ */
+
+template<class Inner>
+void pal::RecordingTransport<Inner>::begin( void )
+{
+  static const uint8_t l_magic[] = { 'S', 'S', 'D', 'T', SSD1306_TRACE_VERSION };
+
+  if ( sink != nullptr )
+  {
+    sink( l_magic, sizeof( l_magic ), sink_context );
+  }
+  last_us = time_us_64();
+
+  inner.begin();
+  return;
+}
+
+
+/*
+ * RecordingTransport::write_commands; sends and records command bytes.
+ */
+
+template<class Inner>
+bool pal::RecordingTransport<Inner>::write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold )
+{
+  uint64_t l_time = time_us_64();
+  bool     l_result;
+
+  l_result = inner.write_commands( p_cmds, p_length, p_hold );
+  record( ( p_hold ? SSD1306_TRACE_HOLD : 0 ) | ( l_result ? 0 : SSD1306_TRACE_FAILED ),
+          l_time, p_cmds, p_length );
+  return l_result;
+}
+
+
+/*
+ * RecordingTransport::write_data; sends and records screen data.
+ */
+
+template<class Inner>
+bool pal::RecordingTransport<Inner>::write_data( uint8_t *p_data, size_t p_length )
+{
+  uint64_t l_time = time_us_64();
+  bool     l_result;
+
+  l_result = inner.write_data( p_data, p_length );
+  record( SSD1306_TRACE_DATA | ( l_result ? 0 : SSD1306_TRACE_FAILED ), l_time, p_data, p_length );
+  return l_result;
+}
+
+
+/*
+ * RecordingTransport::write_data_async; starts the wrapped transport's write
+ *                                       and records the data and trailer,
+ *                                       the data held as the trailer follows
+ *                                       it in the same transaction; a
+ *                                       failure reported later, through the
+ *                                       callback, isn't recorded.
+ */
+
+template<class Inner>
+bool pal::RecordingTransport<Inner>::write_data_async( const uint8_t *p_data, size_t p_length,
+                                                       const uint8_t *p_trailer, size_t p_trailer_length,
+                                                       ssd1306_render_cb_t p_callback, void *p_context )
+{
+  uint64_t l_time = time_us_64();
+  uint8_t  l_failed;
+  bool     l_result;
+
+  l_result = inner.write_data_async( p_data, p_length, p_trailer, p_trailer_length, p_callback, p_context );
+  l_failed = l_result ? 0 : SSD1306_TRACE_FAILED;
+  record( SSD1306_TRACE_DATA | SSD1306_TRACE_ASYNC | ( p_trailer_length > 0 ? SSD1306_TRACE_HOLD : 0 ) | l_failed,
+          l_time, p_data, p_length );
+  if ( p_trailer_length > 0 )
+  {
+    record( SSD1306_TRACE_ASYNC | l_failed, l_time, p_trailer, p_trailer_length );
+  }
+  return l_result;
+}
+
+
+/*
+ * RecordingTransport::is_busy; passed straight through.
+ */
+
+template<class Inner>
+bool pal::RecordingTransport<Inner>::is_busy( void )
+{
+  return inner.is_busy();
+}
+
+#endif /* PAL_SSD1306_TRACE_H */
+
+/* End of file pal-ssd1306-trace.h */
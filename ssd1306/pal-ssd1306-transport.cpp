@@ -0,0 +1,1013 @@
+/*
+ * pal-ssd1306-transport.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * The transports which carry commands and screen data to an SSD1306; over
+ * I2C (blocking or by DMA), SPI, or into a log for testing.
+ */
+
+/* Header files. */
+
+#include <string.h>
+
+#include <pico/stdlib.h>
+#include <hardware/irq.h>
+#include <hardware/gpio.h>
+
+#include "pal-ssd1306-transport.h"
+
+
+/* Static members. */
+
+pal::I2CDMATransport *volatile pal::I2CDMATransport::async_active[NUM_I2CS];
+bool                           pal::I2CDMATransport::irq_installed[NUM_I2CS];
+pal::SPITransport    *volatile pal::SPITransport::async_active[NUM_SPIS];
+bool                           pal::SPITransport::irq_installed = false;
+
+
+/* Functions. */
+
+/*
+ * I2CTransport; constructor, which just saves the bus details.
+ */
+
+pal::I2CTransport::I2CTransport( i2c_inst_t *p_i2c, uint8_t p_address )
+{
+  i2c_instance = p_i2c;
+  address = p_address;
+  return;
+}
+
+
+/*
+ * I2CTransport::begin; nothing to set up, the I2C instance is the caller's.
+ */
+
+void pal::I2CTransport::begin( void )
+{
+  return;
+}
+
+
+/*
+ * I2CTransport::write_control; internal function to send a buffer behind a
+ *                              control byte, borrowed from just in front of
+ *                              it. Holding leaves the bus without a STOP, so
+ *                              the next write follows with a repeated START.
+ */
+
+bool pal::I2CTransport::write_control( uint8_t p_control, uint8_t *p_buffer, size_t p_length, bool p_hold )
+{
+  uint8_t l_saved;
+  bool    l_result;
+
+  l_saved = p_buffer[-1];
+  p_buffer[-1] = p_control;
+  l_result = ( i2c_write_blocking( i2c_instance, address, p_buffer - 1, p_length + 1, p_hold ) > 0 );
+  p_buffer[-1] = l_saved;
+  return l_result;
+}
+
+
+/*
+ * I2CTransport::write_commands; sends command bytes; a control byte with Co=0
+ *                               and D/C#=0 means every byte that follows is a
+ *                               command (or argument) byte.
+ */
+
+bool pal::I2CTransport::write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold )
+{
+  return write_control( 0x00, p_cmds, p_length, p_hold );
+}
+
+
+/*
+ * I2CTransport::write_data; sends screen data, behind a data control byte.
+ */
+
+bool pal::I2CTransport::write_data( uint8_t *p_data, size_t p_length )
+{
+  return write_control( 0x40, p_data, p_length, false );
+}
+
+
+/*
+ * I2CTransport::write_data_async; there's no DMA here, so this just sends the
+ *                                 data and trailer, and reports back. The
+ *                                 trailer is copied to make room for its
+ *                                 control byte, a few bytes at a time; the
+ *                                 pieces are held together on the bus, as
+ *                                 if they were the one write.
+ */
+
+bool pal::I2CTransport::write_data_async( const uint8_t *p_data, size_t p_length,
+                                          const uint8_t *p_trailer, size_t p_trailer_length,
+                                          ssd1306_render_cb_t p_callback, void *p_context )
+{
+  uint8_t l_trailer[8];
+  size_t  l_offset, l_chunk;
+  bool    l_result;
+
+  /* The data is the caller's screen buffer, with room in front of it. */
+  l_result = write_data( (uint8_t *)p_data, p_length );
+
+  /* And the trailer follows, however long it is. */
+  for ( l_offset = 0; l_result && l_offset < p_trailer_length; l_offset += l_chunk )
+  {
+    l_chunk = p_trailer_length - l_offset;
+    if ( l_chunk > sizeof( l_trailer ) - 1 )
+    {
+      l_chunk = sizeof( l_trailer ) - 1;
+    }
+    memcpy( l_trailer + 1, p_trailer + l_offset, l_chunk );
+    l_result = write_commands( l_trailer + 1, l_chunk, l_offset + l_chunk < p_trailer_length );
+  }
+
+  if ( p_callback != nullptr )
+  {
+    p_callback( l_result, p_context );
+  }
+  return l_result;
+}
+
+
+/*
+ * I2CTransport::is_busy; blocking writes are never in flight.
+ */
+
+bool pal::I2CTransport::is_busy( void )
+{
+  return false;
+}
+
+
+/*
+ * I2CDMATransport; constructor; asynchronous writes are opt-in, so nothing
+ *                  is claimed for them yet.
+ */
+
+pal::I2CDMATransport::I2CDMATransport( i2c_inst_t *p_i2c, uint8_t p_address )
+  : I2CTransport( p_i2c, p_address )
+{
+  dma_channel = -1;
+  dma_buffer = nullptr;
+  dma_buffer_sz = 0;
+  owns_dma_buffer = false;
+  render_busy = false;
+  render_ok = true;
+  render_cb = nullptr;
+  render_cb_context = nullptr;
+  return;
+}
+
+
+/*
+ * I2CDMATransport; copy constructor; only the bus details are copied, as the
+ *                  DMA channel and staging buffer can only have one owner.
+ */
+
+pal::I2CDMATransport::I2CDMATransport( const I2CDMATransport &p_other )
+  : I2CDMATransport( p_other.i2c_instance, p_other.address )
+{
+  return;
+}
+
+
+/*
+ * ~I2CDMATransport; destructor, which waits for anything in flight and then
+ *                   releases the DMA channel, if we claimed one.
+ */
+
+pal::I2CDMATransport::~I2CDMATransport()
+{
+  wait_idle();
+
+  if ( dma_channel >= 0 )
+  {
+    dma_channel_unclaim( dma_channel );
+    if ( owns_dma_buffer )
+    {
+      delete[] dma_buffer;
+    }
+    dma_buffer = nullptr;
+  }
+  return;
+}
+
+
+/*
+ * I2CDMATransport::enable_async; claims a DMA channel (any unused one, if none
+ *                                is specified) and sets up the staging buffer
+ *                                for frames of up to max_length bytes; this
+ *                                can be provided (max_length + 3 words, the
+ *                                extra three for the control bytes and a page
+ *                                flip) to control where the DMA reads from,
+ *                                or is allocated. Returns false if no channel
+ *                                or memory is available, or if the I2C
+ *                                interrupt already has an exclusive handler.
+ */
+
+bool pal::I2CDMATransport::enable_async( size_t p_max_length, int p_dma_channel, uint16_t *p_staging )
+{
+  uint l_index, l_irq;
+
+  /* Nothing to do if we're already set up. */
+  if ( dma_channel >= 0 )
+  {
+    return true;
+  }
+
+  /* Completion is signalled by the I2C STOP, so we need that interrupt; we */
+  /* can share it, but not if the application has it all to itself.        */
+  l_index = i2c_hw_index( i2c_instance );
+  l_irq = I2C0_IRQ + l_index;
+  if ( !irq_installed[l_index] && irq_get_exclusive_handler( l_irq ) != nullptr )
+  {
+    return false;
+  }
+
+  /* Claim the channel we've been given, or find a free one. */
+  if ( p_dma_channel < 0 )
+  {
+    p_dma_channel = dma_claim_unused_channel( false );
+    if ( p_dma_channel < 0 )
+    {
+      return false;
+    }
+  }
+  else
+  {
+    dma_channel_claim( p_dma_channel );
+  }
+
+  /* The I2C data register takes 16 bit words, with the control flags in the */
+  /* upper byte, so the DMA stream needs a word for every byte we send.      */
+  dma_buffer_sz = p_max_length + 3;
+  owns_dma_buffer = ( p_staging == nullptr );
+  dma_buffer = owns_dma_buffer ? new uint16_t[dma_buffer_sz] : p_staging;
+  if ( dma_buffer == nullptr )
+  {
+    dma_channel_unclaim( p_dma_channel );
+    return false;
+  }
+  dma_channel = p_dma_channel;
+
+  /* Our handler serves every display on the bus, so only add it the once. */
+  if ( !irq_installed[l_index] )
+  {
+    irq_add_shared_handler( l_irq, async_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY );
+    irq_installed[l_index] = true;
+  }
+  irq_set_enabled( l_irq, true );
+
+  /* All good. */
+  return true;
+}
+
+
+/*
+ * I2CDMATransport::wait_idle; internal function that waits for any write in
+ *                             flight, as the bus is the DMA's until then.
+ */
+
+void pal::I2CDMATransport::wait_idle( void )
+{
+  while ( render_busy )
+  {
+    tight_loop_contents();
+  }
+  return;
+}
+
+
+/*
+ * I2CDMATransport::write_commands; a blocking command write, once the bus is
+ *                                  free.
+ */
+
+bool pal::I2CDMATransport::write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold )
+{
+  wait_idle();
+  return I2CTransport::write_commands( p_cmds, p_length, p_hold );
+}
+
+
+/*
+ * I2CDMATransport::write_data; a blocking data write, once the bus is free.
+ */
+
+bool pal::I2CDMATransport::write_data( uint8_t *p_data, size_t p_length )
+{
+  wait_idle();
+  return I2CTransport::write_data( p_data, p_length );
+}
+
+
+/*
+ * I2CDMATransport::write_data_async; stages the data (and trailer) as a DMA
+ *                                    stream and sets it going, returning at
+ *                                    once; the callback is called from the
+ *                                    I2C interrupt when it's done. Without
+ *                                    DMA, it's a blocking write.
+ */
+
+bool pal::I2CDMATransport::write_data_async( const uint8_t *p_data, size_t p_length,
+                                             const uint8_t *p_trailer, size_t p_trailer_length,
+                                             ssd1306_render_cb_t p_callback, void *p_context )
+{
+  i2c_hw_t           *l_hw;
+  dma_channel_config  l_config;
+  size_t              l_length;
+
+  /* Fall back to a blocking write if we can't do this by DMA. */
+  if ( dma_channel < 0 || p_length + p_trailer_length + 2 > dma_buffer_sz )
+  {
+    wait_idle();
+    return I2CTransport::write_data_async( p_data, p_length, p_trailer, p_trailer_length,
+                                           p_callback, p_context );
+  }
+
+  /* The staging buffer may still be feeding the last write. */
+  wait_idle();
+
+  /* Build the DMA stream; the data control byte, then the screen, with a */
+  /* STOP flagged on the final byte to end the transaction.               */
+  l_length = 0;
+  dma_buffer[l_length++] = 0x40;
+  for ( size_t l_index = 0; l_index < p_length; l_index++ )
+  {
+    dma_buffer[l_length++] = p_data[l_index];
+  }
+
+  /* Any trailing commands follow on after a RESTART, so that they happen */
+  /* the moment the data is complete.                                      */
+  if ( p_trailer_length > 0 )
+  {
+    dma_buffer[l_length++] = I2C_IC_DATA_CMD_RESTART_BITS | 0x00;
+    for ( size_t l_index = 0; l_index < p_trailer_length; l_index++ )
+    {
+      dma_buffer[l_length++] = p_trailer[l_index];
+    }
+  }
+  dma_buffer[l_length-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+  /* Save the callback details, and mark ourselves as busy. */
+  render_cb = p_callback;
+  render_cb_context = p_context;
+  render_ok = true;
+  render_busy = true;
+  async_active[i2c_hw_index( i2c_instance )] = this;
+
+  /* Point the I2C block at our device, clear any stale events and unmask */
+  /* the interrupts that tell us the transfer has finished.               */
+  l_hw = i2c_get_hw( i2c_instance );
+  l_hw->enable = 0;
+  l_hw->tar = address;
+  l_hw->enable = 1;
+  (void)l_hw->clr_stop_det;
+  (void)l_hw->clr_tx_abrt;
+  l_hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+
+  /* And finally set the DMA running, paced by the I2C transmit FIFO. */
+  l_config = dma_channel_get_default_config( dma_channel );
+  channel_config_set_transfer_data_size( &l_config, DMA_SIZE_16 );
+  channel_config_set_read_increment( &l_config, true );
+  channel_config_set_write_increment( &l_config, false );
+  channel_config_set_dreq( &l_config, i2c_get_dreq( i2c_instance, true ) );
+  dma_channel_configure( dma_channel, &l_config, &l_hw->data_cmd, dma_buffer,
+                         l_length, true );
+
+  /* All done, for now. */
+  return true;
+}
+
+
+/*
+ * I2CDMATransport::is_busy; returns true while a DMA write is in flight.
+ */
+
+bool pal::I2CDMATransport::is_busy( void )
+{
+  return render_busy;
+}
+
+
+/*
+ * I2CDMATransport::async_irq_handler; static I2C interrupt handler, which
+ *                                     completes whichever writes have
+ *                                     finished (or failed).
+ */
+
+void pal::I2CDMATransport::async_irq_handler( void )
+{
+  I2CDMATransport *l_transport;
+  i2c_hw_t        *l_hw;
+  uint32_t         l_status;
+
+  /* Check every I2C instance that has a write in flight. */
+  for ( uint l_index = 0; l_index < NUM_I2CS; l_index++ )
+  {
+    l_transport = async_active[l_index];
+    if ( l_transport == nullptr )
+    {
+      continue;
+    }
+
+    /* If the transfer was aborted (no ACK, most likely) stop the DMA. */
+    l_hw = i2c_get_hw( l_transport->i2c_instance );
+    l_status = l_hw->intr_stat;
+    if ( l_status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS )
+    {
+      dma_channel_abort( l_transport->dma_channel );
+      (void)l_hw->clr_tx_abrt;
+      l_transport->render_ok = false;
+    }
+    else if ( ( l_status & I2C_IC_INTR_STAT_R_STOP_DET_BITS ) == 0 )
+    {
+      continue;
+    }
+    (void)l_hw->clr_stop_det;
+
+    /* Either way, the transfer is over so release the bus. */
+    l_hw->intr_mask = 0;
+    async_active[l_index] = nullptr;
+    l_transport->render_busy = false;
+
+    /* And let the caller know. */
+    if ( l_transport->render_cb != nullptr )
+    {
+      l_transport->render_cb( l_transport->render_ok, l_transport->render_cb_context );
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * SPITransport; constructor, which just saves the bus details; CS# is left
+ *               to the SPI block (or tied low) if no pin is given, and RES#
+ *               is left alone. Asynchronous writes are opt-in, so nothing is
+ *               claimed for them yet.
+ */
+
+pal::SPITransport::SPITransport( spi_inst_t *p_spi, uint p_dc_pin, int p_cs_pin, int p_reset_pin )
+{
+  spi_instance = p_spi;
+  dc_pin = p_dc_pin;
+  cs_pin = p_cs_pin;
+  reset_pin = p_reset_pin;
+
+  dma_channel = -1;
+  dma_buffer = nullptr;
+  dma_buffer_sz = 0;
+  owns_dma_buffer = false;
+  trailer_length = 0;
+  render_busy = false;
+  render_cb = nullptr;
+  render_cb_context = nullptr;
+  return;
+}
+
+
+/*
+ * SPITransport; copy constructor; only the bus details are copied, as the
+ *               DMA channel and staging buffer can only have one owner.
+ */
+
+pal::SPITransport::SPITransport( const SPITransport &p_other )
+  : SPITransport( p_other.spi_instance, p_other.dc_pin, p_other.cs_pin, p_other.reset_pin )
+{
+  return;
+}
+
+
+/*
+ * ~SPITransport; destructor, which waits for anything in flight and then
+ *                releases the DMA channel, if we claimed one.
+ */
+
+pal::SPITransport::~SPITransport()
+{
+  wait_idle();
+
+  if ( dma_channel >= 0 )
+  {
+    dma_channel_set_irq0_enabled( dma_channel, false );
+    dma_channel_unclaim( dma_channel );
+    if ( owns_dma_buffer )
+    {
+      delete[] dma_buffer;
+    }
+    dma_buffer = nullptr;
+  }
+  return;
+}
+
+
+/*
+ * SPITransport::begin; sets up the D/C# and CS# pins as outputs, and resets
+ *                      the display if we have its RES# pin.
+ */
+
+void pal::SPITransport::begin( void )
+{
+  gpio_init( dc_pin );
+  gpio_set_dir( dc_pin, GPIO_OUT );
+
+  if ( cs_pin >= 0 )
+  {
+    gpio_init( cs_pin );
+    gpio_set_dir( cs_pin, GPIO_OUT );
+    gpio_put( cs_pin, 1 );
+  }
+
+  /* RES# needs holding low for at least 3us, once the supply is stable. */
+  if ( reset_pin >= 0 )
+  {
+    gpio_init( reset_pin );
+    gpio_set_dir( reset_pin, GPIO_OUT );
+    gpio_put( reset_pin, 1 );
+    sleep_ms( 1 );
+    gpio_put( reset_pin, 0 );
+    sleep_ms( 10 );
+    gpio_put( reset_pin, 1 );
+    sleep_ms( 1 );
+  }
+  return;
+}
+
+
+/*
+ * SPITransport::enable_async; claims a DMA channel (any unused one, if none
+ *                             is specified) and sets up the staging buffer
+ *                             for frames of up to max_length bytes; this can
+ *                             be provided (max_length bytes) or allocated.
+ *                             Returns false if no channel or memory is
+ *                             available.
+ */
+
+bool pal::SPITransport::enable_async( size_t p_max_length, int p_dma_channel, uint8_t *p_staging )
+{
+  /* Nothing to do if we're already set up. */
+  if ( dma_channel >= 0 )
+  {
+    return true;
+  }
+
+  /* Claim the channel we've been given, or find a free one. */
+  if ( p_dma_channel < 0 )
+  {
+    p_dma_channel = dma_claim_unused_channel( false );
+    if ( p_dma_channel < 0 )
+    {
+      return false;
+    }
+  }
+  else
+  {
+    dma_channel_claim( p_dma_channel );
+  }
+
+  /* The frame is staged, so drawing can carry on while it's sent. */
+  dma_buffer_sz = p_max_length;
+  owns_dma_buffer = ( p_staging == nullptr );
+  dma_buffer = owns_dma_buffer ? new uint8_t[dma_buffer_sz] : p_staging;
+  if ( dma_buffer == nullptr )
+  {
+    dma_channel_unclaim( p_dma_channel );
+    return false;
+  }
+  dma_channel = p_dma_channel;
+
+  /* Completion is signalled by the DMA interrupt, which other code may  */
+  /* well be using too; so share it, and only add our handler the once. */
+  if ( !irq_installed )
+  {
+    irq_add_shared_handler( DMA_IRQ_0, async_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY );
+    irq_set_enabled( DMA_IRQ_0, true );
+    irq_installed = true;
+  }
+  dma_channel_set_irq0_enabled( dma_channel, true );
+
+  /* All good. */
+  return true;
+}
+
+
+/*
+ * SPITransport::select; internal function to set D/C# for data or commands,
+ *                       and select the display.
+ */
+
+void pal::SPITransport::select( bool p_data )
+{
+  gpio_put( dc_pin, p_data );
+  if ( cs_pin >= 0 )
+  {
+    gpio_put( cs_pin, 0 );
+  }
+  return;
+}
+
+
+/*
+ * SPITransport::deselect; internal function to release the display.
+ */
+
+void pal::SPITransport::deselect( void )
+{
+  if ( cs_pin >= 0 )
+  {
+    gpio_put( cs_pin, 1 );
+  }
+  return;
+}
+
+
+/*
+ * SPITransport::write_mode; internal function to send a buffer with D/C#
+ *                           set for data or commands. spi_write_blocking
+ *                           doesn't return until the last bit is out, so it's
+ *                           safe to change D/C# again straight afterwards.
+ */
+
+bool pal::SPITransport::write_mode( bool p_data, const uint8_t *p_buffer, size_t p_length )
+{
+  int l_written;
+
+  select( p_data );
+  l_written = spi_write_blocking( spi_instance, p_buffer, p_length );
+  deselect();
+  return ( l_written == (int)p_length );
+}
+
+
+/*
+ * SPITransport::wait_idle; internal function that waits for any write in
+ *                          flight, as the bus is the DMA's until then.
+ */
+
+void pal::SPITransport::wait_idle( void )
+{
+  while ( render_busy )
+  {
+    tight_loop_contents();
+  }
+  return;
+}
+
+
+/*
+ * SPITransport::write_commands; sends command bytes, with D/C# low. There's
+ *                               no bus to hold on to, so hold is ignored.
+ */
+
+bool pal::SPITransport::write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold )
+{
+  wait_idle();
+  return write_mode( false, p_cmds, p_length );
+}
+
+
+/*
+ * SPITransport::write_data; sends screen data, with D/C# high.
+ */
+
+bool pal::SPITransport::write_data( uint8_t *p_data, size_t p_length )
+{
+  wait_idle();
+  return write_mode( true, p_data, p_length );
+}
+
+
+/*
+ * SPITransport::write_data_async; stages the data and sets the DMA sending
+ *                                 it, returning at once; the trailer is sent
+ *                                 from the DMA interrupt, once D/C# can be
+ *                                 dropped, and then the callback is called.
+ *                                 Without DMA, it's a blocking write.
+ */
+
+bool pal::SPITransport::write_data_async( const uint8_t *p_data, size_t p_length,
+                                          const uint8_t *p_trailer, size_t p_trailer_length,
+                                          ssd1306_render_cb_t p_callback, void *p_context )
+{
+  dma_channel_config l_config;
+  bool               l_result;
+
+  /* The staging buffer may still be feeding the last write. */
+  wait_idle();
+
+  /* Fall back to a blocking write if we can't do this by DMA. */
+  if ( dma_channel < 0 || p_length > dma_buffer_sz || p_trailer_length > sizeof( trailer ) )
+  {
+    l_result = write_mode( true, p_data, p_length );
+    if ( l_result && p_trailer_length > 0 )
+    {
+      l_result = write_mode( false, p_trailer, p_trailer_length );
+    }
+
+    if ( p_callback != nullptr )
+    {
+      p_callback( l_result, p_context );
+    }
+    return l_result;
+  }
+
+  /* Stage the frame, and keep the trailer for later. */
+  memcpy( dma_buffer, p_data, p_length );
+  memcpy( trailer, p_trailer, p_trailer_length );
+  trailer_length = p_trailer_length;
+
+  /* Save the callback details, and mark ourselves as busy. */
+  render_cb = p_callback;
+  render_cb_context = p_context;
+  render_busy = true;
+  async_active[spi_get_index( spi_instance )] = this;
+
+  /* And set the DMA running, paced by the SPI transmit FIFO. */
+  select( true );
+  l_config = dma_channel_get_default_config( dma_channel );
+  channel_config_set_transfer_data_size( &l_config, DMA_SIZE_8 );
+  channel_config_set_read_increment( &l_config, true );
+  channel_config_set_write_increment( &l_config, false );
+  channel_config_set_dreq( &l_config, spi_get_dreq( spi_instance, true ) );
+  dma_channel_configure( dma_channel, &l_config, &spi_get_hw( spi_instance )->dr, dma_buffer,
+                         p_length, true );
+
+  /* All done, for now. */
+  return true;
+}
+
+
+/*
+ * SPITransport::is_busy; returns true while a DMA write is in flight.
+ */
+
+bool pal::SPITransport::is_busy( void )
+{
+  return render_busy;
+}
+
+
+/*
+ * SPITransport::async_irq_handler; static (shared) DMA interrupt handler,
+ *                                  which completes whichever writes have
+ *                                  finished.
+ */
+
+void pal::SPITransport::async_irq_handler( void )
+{
+  SPITransport *l_transport;
+  spi_hw_t     *l_hw;
+
+  for ( uint l_index = 0; l_index < NUM_SPIS; l_index++ )
+  {
+    l_transport = async_active[l_index];
+    if ( l_transport == nullptr || !dma_channel_get_irq0_status( l_transport->dma_channel ) )
+    {
+      continue;
+    }
+    dma_channel_acknowledge_irq0( l_transport->dma_channel );
+
+    /* The DMA is done once the last byte is in the FIFO; wait for it to */
+    /* be shifted out (a few microseconds at most) before touching D/C#, */
+    /* and tidy up the receive side we've been ignoring.                 */
+    l_hw = spi_get_hw( l_transport->spi_instance );
+    while ( l_hw->sr & SPI_SSPSR_BSY_BITS )
+    {
+      tight_loop_contents();
+    }
+    while ( spi_is_readable( l_transport->spi_instance ) )
+    {
+      (void)l_hw->dr;
+    }
+    l_hw->icr = SPI_SSPICR_RORIC_BITS;
+    l_transport->deselect();
+
+    /* Send any trailing commands; these are only a byte or two. */
+    if ( l_transport->trailer_length > 0 )
+    {
+      l_transport->write_mode( false, l_transport->trailer, l_transport->trailer_length );
+    }
+
+    /* The transfer is over so release the bus, and let the caller know. */
+    async_active[l_index] = nullptr;
+    l_transport->render_busy = false;
+    if ( l_transport->render_cb != nullptr )
+    {
+      l_transport->render_cb( true, l_transport->render_cb_context );
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * MockTransport; constructor, starting with an empty log.
+ */
+
+pal::MockTransport::MockTransport()
+{
+  failing = false;
+  reset();
+  return;
+}
+
+
+/*
+ * MockTransport; copy constructor; the log refers to its own storage, so the
+ *                copy starts with an empty one.
+ */
+
+pal::MockTransport::MockTransport( const MockTransport &p_other )
+{
+  failing = p_other.failing;
+  reset();
+  return;
+}
+
+
+/*
+ * MockTransport::record; internal function to log a write, keeping as much
+ *                        as will fit and counting the rest.
+ */
+
+bool pal::MockTransport::record( bool p_command, bool p_hold, const uint8_t *p_buffer, size_t p_length )
+{
+  ssd1306_transaction_t *l_entry;
+
+  total_transactions++;
+  total_bytes += p_length;
+
+  if ( log_count < SSD1306_MOCK_TRANSACTIONS )
+  {
+    l_entry = &log[log_count++];
+    l_entry->command = p_command;
+    l_entry->hold = p_hold;
+    l_entry->length = p_length;
+    l_entry->data = nullptr;
+
+    /* Keep the bytes themselves too, if there's room. */
+    if ( log_data_length + p_length <= SSD1306_MOCK_BYTES )
+    {
+      memcpy( log_data + log_data_length, p_buffer, p_length );
+      l_entry->data = log_data + log_data_length;
+      log_data_length += p_length;
+    }
+  }
+
+  return !failing;
+}
+
+
+/*
+ * MockTransport::begin; nothing to set up.
+ */
+
+void pal::MockTransport::begin( void )
+{
+  return;
+}
+
+
+/*
+ * MockTransport::write_commands; logs a command write.
+ */
+
+bool pal::MockTransport::write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold )
+{
+  return record( true, p_hold, p_cmds, p_length );
+}
+
+
+/*
+ * MockTransport::write_data; logs a data write.
+ */
+
+bool pal::MockTransport::write_data( uint8_t *p_data, size_t p_length )
+{
+  return record( false, false, p_data, p_length );
+}
+
+
+/*
+ * MockTransport::write_data_async; logs the data and trailer, and reports
+ *                                  back straight away. They're logged as
+ *                                  the DMA transports send them: the data
+ *                                  held, with the trailer following on
+ *                                  after a repeated START.
+ */
+
+bool pal::MockTransport::write_data_async( const uint8_t *p_data, size_t p_length,
+                                           const uint8_t *p_trailer, size_t p_trailer_length,
+                                           ssd1306_render_cb_t p_callback, void *p_context )
+{
+  bool l_result;
+
+  l_result = record( false, p_trailer_length > 0, p_data, p_length );
+  if ( p_trailer_length > 0 )
+  {
+    l_result = record( true, false, p_trailer, p_trailer_length ) && l_result;
+  }
+
+  if ( p_callback != nullptr )
+  {
+    p_callback( l_result, p_context );
+  }
+  return l_result;
+}
+
+
+/*
+ * MockTransport::is_busy; nothing is ever in flight.
+ */
+
+bool pal::MockTransport::is_busy( void )
+{
+  return false;
+}
+
+
+/*
+ * MockTransport::reset; empties the log, and zeroes the counters.
+ */
+
+void pal::MockTransport::reset( void )
+{
+  log_count = 0;
+  log_data_length = 0;
+  total_transactions = 0;
+  total_bytes = 0;
+  return;
+}
+
+
+/*
+ * MockTransport::set_failing; makes every write report failure (or not), to
+ *                             exercise error handling.
+ */
+
+void pal::MockTransport::set_failing( bool p_failing )
+{
+  failing = p_failing;
+  return;
+}
+
+
+/*
+ * MockTransport::count; returns the number of writes in the log.
+ */
+
+size_t pal::MockTransport::count( void )
+{
+  return log_count;
+}
+
+
+/*
+ * MockTransport::transaction; returns a logged write, or nullptr if there
+ *                             isn't one at that index. The data is nullptr
+ *                             if the log ran out of room for the bytes.
+ */
+
+const pal::ssd1306_transaction_t *pal::MockTransport::transaction( size_t p_index )
+{
+  if ( p_index >= log_count )
+  {
+    return nullptr;
+  }
+  return &log[p_index];
+}
+
+
+/*
+ * MockTransport::transactions_sent; returns the number of writes since the
+ *                                   last reset, logged or not.
+ */
+
+size_t pal::MockTransport::transactions_sent( void )
+{
+  return total_transactions;
+}
+
+
+/*
+ * MockTransport::bytes_sent; returns the number of bytes written since the
+ *                            last reset, logged or not; this is the payload,
+ *                            without any bus overheads.
+ */
+
+size_t pal::MockTransport::bytes_sent( void )
+{
+  return total_bytes;
+}
+
+
+/* End of file pal-ssd1306-transport.cpp */
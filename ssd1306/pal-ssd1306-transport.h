@@ -0,0 +1,225 @@
+/*
+ * pal-ssd1306-transport.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * The transports which carry commands and screen data to an SSD1306. The
+ * driver is a template over its transport, so there's no virtual dispatch;
+ * a transport is any class providing these functions:
+ *
+ *   void begin( void );
+ *     Called once by the driver, before the display is initialised.
+ *
+ *   bool write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold );
+ *     Sends a sequence of command bytes. If hold is set, more is about to
+ *     follow and the transport may keep hold of the bus for it.
+ *
+ *   bool write_data( uint8_t *p_data, size_t p_length );
+ *     Sends screen data, to wherever the current window points.
+ *
+ *   bool write_data_async( const uint8_t *p_data, size_t p_length,
+ *                          const uint8_t *p_trailer, size_t p_trailer_length,
+ *                          ssd1306_render_cb_t p_callback, void *p_context );
+ *     Starts sending screen data, followed by the trailing command bytes (if
+ *     any), returning straight away; the data must be staged before this
+ *     returns. Transports which can't do this just send it, and call the
+ *     callback before returning.
+ *
+ *   bool is_busy( void );
+ *     Returns true while an asynchronous write is in flight.
+ *
+ * For both writes the byte just before the buffer must be writable; it is
+ * borrowed during the call (over I2C, for the control byte) and restored.
+ */
+
+#ifndef   PAL_SSD1306_TRANSPORT_H
+#define   PAL_SSD1306_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <hardware/i2c.h>
+#include <hardware/dma.h>
+#include <hardware/spi.h>
+
+/* The mock transport records this many transactions, and bytes of them. */
+#define SSD1306_MOCK_TRANSACTIONS 64
+#define SSD1306_MOCK_BYTES        2048
+
+namespace pal
+{
+  /* Completion callback for asynchronous renders; called from IRQ context. */
+  typedef void (*ssd1306_render_cb_t)( bool p_success, void *p_context );
+
+  /* A single write, as recorded by the mock transport. */
+  typedef struct
+  {
+    bool           command;
+    bool           hold;
+    const uint8_t *data;
+    size_t         length;
+  } ssd1306_transaction_t;
+
+
+  /*
+   * I2CTransport; plain blocking I2C, with each write a single transaction
+   *               behind the appropriate control byte.
+   */
+
+  class I2CTransport
+  {
+  protected:
+    i2c_inst_t *i2c_instance;
+    uint8_t     address;
+
+    bool write_control( uint8_t p_control, uint8_t *p_buffer, size_t p_length, bool p_hold );
+
+  public:
+    explicit I2CTransport( i2c_inst_t *p_i2c, uint8_t p_address = 0x3C );
+
+    void begin( void );
+    bool write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold );
+    bool write_data( uint8_t *p_data, size_t p_length );
+    bool write_data_async( const uint8_t *p_data, size_t p_length,
+                           const uint8_t *p_trailer, size_t p_trailer_length,
+                           ssd1306_render_cb_t p_callback, void *p_context );
+    bool is_busy( void );
+  };
+
+
+  /*
+   * I2CDMATransport; I2C which, once enable_async has been called, can send
+   *                  whole frames by DMA in the background. Until then, it
+   *                  behaves exactly like I2CTransport.
+   */
+
+  class I2CDMATransport : public I2CTransport
+  {
+  private:
+    int                  dma_channel;
+    uint16_t            *dma_buffer;
+    size_t               dma_buffer_sz;
+    bool                 owns_dma_buffer;
+    volatile bool        render_busy;
+    volatile bool        render_ok;
+    ssd1306_render_cb_t  render_cb;
+    void                *render_cb_context;
+
+    static I2CDMATransport *volatile async_active[NUM_I2CS];
+    static bool                      irq_installed[NUM_I2CS];
+    static void async_irq_handler( void );
+
+    void wait_idle( void );
+
+  public:
+    explicit I2CDMATransport( i2c_inst_t *p_i2c, uint8_t p_address = 0x3C );
+    I2CDMATransport( const I2CDMATransport &p_other );
+    ~I2CDMATransport();
+
+    bool enable_async( size_t p_max_length, int p_dma_channel = -1, uint16_t *p_staging = nullptr );
+
+    bool write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold );
+    bool write_data( uint8_t *p_data, size_t p_length );
+    bool write_data_async( const uint8_t *p_data, size_t p_length,
+                           const uint8_t *p_trailer, size_t p_trailer_length,
+                           ssd1306_render_cb_t p_callback, void *p_context );
+    bool is_busy( void );
+  };
+
+
+  /*
+   * SPITransport; 4-wire SPI, with a GPIO driving the D/C# line (low for
+   *               commands, high for data) and optionally ones for CS# and
+   *               RES#. The SPI instance itself should already be
+   *               initialised, at up to 10MHz. Once enable_async has been
+   *               called, whole frames can be sent by DMA in the background.
+   */
+
+  class SPITransport
+  {
+  protected:
+    spi_inst_t *spi_instance;
+    uint        dc_pin;
+    int         cs_pin;
+    int         reset_pin;
+
+    int                  dma_channel;
+    uint8_t             *dma_buffer;
+    size_t               dma_buffer_sz;
+    bool                 owns_dma_buffer;
+    uint8_t              trailer[4];
+    size_t               trailer_length;
+    volatile bool        render_busy;
+    ssd1306_render_cb_t  render_cb;
+    void                *render_cb_context;
+
+    static SPITransport *volatile async_active[NUM_SPIS];
+    static bool                   irq_installed;
+    static void async_irq_handler( void );
+
+    void select( bool p_data );
+    void deselect( void );
+    bool write_mode( bool p_data, const uint8_t *p_buffer, size_t p_length );
+    void wait_idle( void );
+
+  public:
+    explicit SPITransport( spi_inst_t *p_spi, uint p_dc_pin, int p_cs_pin = -1, int p_reset_pin = -1 );
+    SPITransport( const SPITransport &p_other );
+    ~SPITransport();
+
+    bool enable_async( size_t p_max_length, int p_dma_channel = -1, uint8_t *p_staging = nullptr );
+
+    void begin( void );
+    bool write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold );
+    bool write_data( uint8_t *p_data, size_t p_length );
+    bool write_data_async( const uint8_t *p_data, size_t p_length,
+                           const uint8_t *p_trailer, size_t p_trailer_length,
+                           ssd1306_render_cb_t p_callback, void *p_context );
+    bool is_busy( void );
+  };
+
+
+  /*
+   * MockTransport; talks to no hardware at all, but records what it would
+   *                have sent; for testing and measuring the driver. Writes
+   *                beyond the limits of the log are counted, but not kept.
+   */
+
+  class MockTransport
+  {
+  private:
+    ssd1306_transaction_t log[SSD1306_MOCK_TRANSACTIONS];
+    uint8_t               log_data[SSD1306_MOCK_BYTES];
+    size_t                log_count;
+    size_t                log_data_length;
+    size_t                total_transactions;
+    size_t                total_bytes;
+    bool                  failing;
+
+    bool record( bool p_command, bool p_hold, const uint8_t *p_buffer, size_t p_length );
+
+  public:
+    MockTransport();
+    MockTransport( const MockTransport &p_other );
+
+    void begin( void );
+    bool write_commands( uint8_t *p_cmds, size_t p_length, bool p_hold );
+    bool write_data( uint8_t *p_data, size_t p_length );
+    bool write_data_async( const uint8_t *p_data, size_t p_length,
+                           const uint8_t *p_trailer, size_t p_trailer_length,
+                           ssd1306_render_cb_t p_callback, void *p_context );
+    bool is_busy( void );
+
+    void                         reset( void );
+    void                         set_failing( bool p_failing );
+    size_t                       count( void );
+    const ssd1306_transaction_t *transaction( size_t p_index );
+    size_t                       transactions_sent( void );
+    size_t                       bytes_sent( void );
+  };
+}
+
+#endif /* PAL_SSD1306_TRANSPORT_H */
+
+/* End of file pal-ssd1306-transport.h */
@@ -16,211 +16,530 @@
 #include <string.h>
 
 #include <pico/stdlib.h>
+#include <pico/multicore.h>
+#include <hardware/sync.h>
 
 #include "pal-ssd1306.h"
+#include "fonts/pal-ssd1306-font-5x7.h"
+
+
+/* Types. */
+
+/* A word of the screen buffer, which may be accessed as bytes too. */
+typedef uint32_t __attribute__(( __may_alias__ )) ssd1306_word_t;
+
+
+/* Static members. */
+
+bool pal::SSD1306Canvas::core1_launched = false;
 
 
 /* Functions. */
 
+/*
+ * apply_mask; internal function which sets, clears or flips the bits in the
+ *             mask, in a single byte.
+ */
+
+static inline void apply_mask( uint8_t *p_byte, uint8_t p_mask, pal::ssd1306_draw_mode_t p_mode )
+{
+  switch( p_mode )
+  {
+    case pal::DRAW_SET:
+      *p_byte |= p_mask;
+      break;
+    case pal::DRAW_CLEAR:
+      *p_byte &= ~p_mask;
+      break;
+    default:
+      *p_byte ^= p_mask;
+      break;
+  }
+  return;
+}
+
+
+/*
+ * apply_mask_run; internal function which sets, clears or flips the bits in
+ *                 the mask, across a run of bytes; once aligned, it works a
+ *                 word at a time.
+ */
+
+static void apply_mask_run( uint8_t *p_bytes, size_t p_length, uint8_t p_mask, pal::ssd1306_draw_mode_t p_mode )
+{
+  ssd1306_word_t *l_words;
+  uint32_t        l_mask;
+
+  /* Bytes up to a word boundary. */
+  while ( p_length > 0 && ( (uintptr_t)p_bytes & 0x03 ) != 0 )
+  {
+    apply_mask( p_bytes++, p_mask, p_mode );
+    p_length--;
+  }
+
+  /* Then whole words. */
+  l_mask = p_mask * 0x01010101u;
+  l_words = (ssd1306_word_t *)p_bytes;
+  switch( p_mode )
+  {
+    case pal::DRAW_SET:
+      for ( ; p_length >= 4; p_length -= 4 )
+      {
+        *l_words++ |= l_mask;
+      }
+      break;
+    case pal::DRAW_CLEAR:
+      for ( ; p_length >= 4; p_length -= 4 )
+      {
+        *l_words++ &= ~l_mask;
+      }
+      break;
+    default:
+      for ( ; p_length >= 4; p_length -= 4 )
+      {
+        *l_words++ ^= l_mask;
+      }
+      break;
+  }
+
+  /* And whatever bytes are left. */
+  p_bytes = (uint8_t *)l_words;
+  while ( p_length-- > 0 )
+  {
+    apply_mask( p_bytes++, p_mask, p_mode );
+  }
+  return;
+}
+
+
 /*
  * Constructor; allocates the screen buffer, and initialises the device.
  */
 
 pal::SSD1306::SSD1306( uint8_t p_width, uint8_t p_height, i2c_inst_t *p_i2c, 
                        uint8_t p_address, bool p_ext_vcc )
+  : SSD1306( p_width, p_height, nullptr, p_i2c, p_address, p_ext_vcc )
+{
+  return;
+}
+
+
+/*
+ * Constructor; initialises the device, using the screen buffer provided or
+ *              allocating one if that is null. A provided buffer must be at
+ *              least buffer_size() bytes long, and remains owned by (and so
+ *              must be freed by) the caller.
+ */
+
+pal::SSD1306::SSD1306( uint8_t p_width, uint8_t p_height, uint8_t *p_buffer,
+                       i2c_inst_t *p_i2c, uint8_t p_address, bool p_ext_vcc )
+  : SSD1306Driver( p_width, p_height, p_buffer, I2CDMATransport( p_i2c, p_address ), p_ext_vcc )
+{
+  return;
+}
+
+
+/*
+ * SSD1306Canvas; constructor, which sets up the screen buffer - allocating
+ *                it, unless we've been given one.
+ */
+
+pal::SSD1306Canvas::SSD1306Canvas( uint8_t p_width, uint8_t p_height, uint8_t *p_buffer )
 {
   /* Save our basic parameters. */
   width = p_width;
   height = p_height;
-  address = p_address;
-  external_vcc = p_ext_vcc;
-  i2c_instance = p_i2c;
 
   /* Work out the size of the send buffer; these needs to be the screen size */
   /* which is a bitfield, so width * height/8).                              */
   pagesize = ( height + 7 ) / 8;
   screen_buffer_sz = ( width * pagesize ) + 1;
 
-  /* Allocate that buffer. */
-  screen_buffer = new uint8_t[screen_buffer_sz];
+  /* Allocate that buffer, unless we've been given one. */
+  owns_buffer = ( p_buffer == nullptr );
+  screen_buffer = owns_buffer ? new uint8_t[screen_buffer_sz] : p_buffer;
   screen_ptr = screen_buffer+1;
 
-  /* Last thing to do is to send our initialisation commands to the device. */
-  /* This command sequence is mostly derived from Adafruits SSD1306 driver. */
-  write_cmd( DISPLAYOFF );
-  write_cmd( SETDISPLAYCLOCKDIV, 0x80 );
-  write_cmd( SETMULTIPLEX, height - 1 );
-  write_cmd( SETDISPLAYOFFSET, 0x00 );
-  write_cmd( SETSTARTLINE );
-  write_cmd( CHARGEPUMP, external_vcc ? 0x10 : 0x14 );
-  write_cmd( MEMORYMODE, 0x00 );
-  write_cmd( SEGREMAP );
-  write_cmd( COMSCANDEC );
-  write_cmd( SETCOMPINS, height == 64 ? 0x12 : 0x02 );
-  write_cmd( SETCONTRAST, 0xFF );
-  write_cmd( SETPRECHARGE, external_vcc ? 0x22 : 0xF1 );
-  write_cmd( SETVCOMDETECT, 0x40 );
-  write_cmd( DISPLAYALLON );
-  write_cmd( NORMALDISPLAY );
-  write_cmd( DISPLAYON );
+  /* Nothing is being rendered on core1. */
+  core1_busy = false;
+  core1_renderer = nullptr;
 
-  /* All sorted then. */
+  /* Glyphs aren't cached unless asked for. */
+  glyph_cache = nullptr;
+  glyph_cache_slots = 0;
+  glyph_cache_clock = 0;
+  owns_glyph_cache = false;
+
+  /* Start the counters from nothing. */
+  reset_stats();
+
+  /* And everything is dirty, until we know what's on the display. */
+  set_dirty();
   return;
 }
 
 
 /*
- * Destructor; frees up the screen buffer memory, and we're done. 
+ * ~SSD1306Canvas; destructor, which frees up the screen buffer memory, and
+ *                 we're done.
  */
 
-pal::SSD1306::~SSD1306()
+pal::SSD1306Canvas::~SSD1306Canvas()
 {
-  /* Free up our allocated memory. */
-  delete screen_buffer;
+  if ( owns_buffer )
+  {
+    delete[] screen_buffer;
+  }
   screen_buffer = screen_ptr = nullptr;
 
-  /* That's all! */
+  if ( owns_glyph_cache )
+  {
+    delete[] glyph_cache;
+  }
+  glyph_cache = nullptr;
+  return;
+}
+
+
+/*
+ * clear; turns off all pixels in the screen buffer, giving us a blank slate
+ *        on which to draw.
+ */
+
+void pal::SSD1306Canvas::clear( void )
+{
+  /* Don't try and do this if we don't have a screen buffer. */
+  if ( screen_buffer == nullptr )
+  {
+    return;
+  }
+
+  /* Fairly simple, just blank the buffer - which changes everything. */
+  memset( screen_buffer, 0, screen_buffer_sz );
+  set_dirty();
   return;
 }
 
 
 /*
- * write_cmd; internal function that assembles command sequences and sends
- *            them to the display via write_buffer
+ * frame; returns the screen buffer itself (without copying), laid out as the
+ *        display expects - one byte per column per page, with the least
+ *        significant bit at the top - for code that wants to draw straight
+ *        into it. Call mark_dirty_region for anything changed this way.
+ */
+
+uint8_t *pal::SSD1306Canvas::frame( void )
+{
+  return screen_ptr;
+}
+
+
+/*
+ * frame_size; returns the number of bytes in the buffer returned by frame.
  */
 
-bool pal::SSD1306::write_cmd( ssd1306_cmd_t p_cmd, int16_t p_arg1, int16_t p_arg2 )
+size_t pal::SSD1306Canvas::frame_size( void )
 {
-  static uint8_t l_buffer[2];
+  return screen_buffer_sz - 1;
+}
+
+
+/*
+ * mark_dirty_region; flags an area of the screen as changed, so that render
+ *                    sends it; needed after writing directly into frame().
+ */
 
-  /* The command and (possible) argument need to be written seperately, from */
-  /* the look of things.                                                     */
-  l_buffer[0] = 0x00;
-  l_buffer[1] = p_cmd;
+void pal::SSD1306Canvas::mark_dirty_region( uint8_t p_x, uint8_t p_y, uint8_t p_width, uint8_t p_height )
+{
+  uint16_t l_last_x, l_last_y;
 
-  if ( p_arg1 >= 0 )
+  /* Nothing to do for an empty area. */
+  if ( p_width == 0 || p_height == 0 || p_x >= width || p_y >= height )
   {
-    /* Flush the command, and assuming that's fine build the arg buffer. */
-    if ( !write_buffer( l_buffer, 2 ) )
-    {
-      return false;
-    }
-    l_buffer[0] = 0x00;
-    l_buffer[1] = p_arg1 & 0xFF;
+    return;
   }
 
-  if ( p_arg2 >= 0 )
+  /* Clip the area to the display. */
+  l_last_x = ( p_x + p_width > width ) ? width - 1 : p_x + p_width - 1;
+  l_last_y = ( p_y + p_height > height ) ? height - 1 : p_y + p_height - 1;
+
+  /* And widen the window on each page it covers. */
+  for ( uint8_t l_page = p_y >> 3; l_page <= ( l_last_y >> 3 ); l_page++ )
   {
-    /* Flush the command, and assuming that's fine build the arg buffer. */
-    if ( !write_buffer( l_buffer, 2 ) )
-    {
-      return false;
-    }
-    l_buffer[0] = 0x00;
-    l_buffer[1] = p_arg2 & 0xFF;
+    mark_dirty( l_page, p_x );
+    mark_dirty( l_page, l_last_x );
   }
+  return;
+}
+
 
-  return write_buffer( l_buffer, 2 );
+/*
+ * set_dirty; internal function to mark the whole screen as dirty.
+ */
+
+void pal::SSD1306Canvas::set_dirty( void )
+{
+  for ( uint8_t l_page = 0; l_page < SSD1306_MAX_PAGES; l_page++ )
+  {
+    dirty_min[l_page] = 0;
+    dirty_max[l_page] = width - 1;
+  }
+  return;
 }
 
 
 /*
- * write_buffer; internal function to send an arbitrary buffer to the display
- *               via i2c.
+ * stats; returns the performance counters, which are all zero unless they're
+ *        being kept (see SSD1306_STATS).
  */
 
-bool pal::SSD1306::write_buffer( uint8_t *p_buffer, size_t p_length )
+pal::ssd1306_stats_t pal::SSD1306Canvas::stats( void )
 {
-  return ( i2c_write_blocking( i2c_instance, address, p_buffer, p_length, false ) > 0 );
-  return true;
+  ssd1306_stats_t l_stats;
+
+#if SSD1306_STATS
+  l_stats = stats_data;
+  l_stats.render_avg_us = l_stats.frames ? stats_render_total_us / l_stats.frames : 0;
+#else
+  memset( &l_stats, 0, sizeof( l_stats ) );
+#endif
+  return l_stats;
 }
 
 
 /*
- * clear; turns off all pixels in the screen buffer, giving us a blank slate
- *        on which to draw.
+ * reset_stats; zeroes the performance counters.
  */
 
-void pal::SSD1306::clear( void )
+void pal::SSD1306Canvas::reset_stats( void )
 {
-  /* Don't try and do this if we don't have a screen buffer. */
-  if ( screen_buffer == nullptr )
+#if SSD1306_STATS
+  memset( &stats_data, 0, sizeof( stats_data ) );
+  stats_render_total_us = 0;
+  stats_pixels = 0;
+#endif
+  return;
+}
+
+
+#if SSD1306_STATS
+
+/*
+ * stats_write; internal function to count a write to the transport, and
+ *              whether or not it worked.
+ */
+
+void pal::SSD1306Canvas::stats_write( size_t p_length, bool p_result )
+{
+  stats_data.transactions++;
+  stats_data.bytes_sent += p_length;
+  if ( !p_result )
   {
-    return;
+    stats_data.write_failures++;
   }
-
-  /* Fairly simple, just blank the buffer. */
-  memset( screen_buffer, 0, screen_buffer_sz );
   return;
 }
 
 
 /*
- * render; sends the current screen buffer to the display.
+ * stats_frame; internal function to count a rendered frame, which started at
+ *              the given time and sent the given number of dirty bytes.
  */
 
-void pal::SSD1306::render( void )
+void pal::SSD1306Canvas::stats_frame( uint64_t p_start_us, size_t p_dirty_bytes )
 {
-  static uint8_t l_cmd_buffer[7];
+  uint32_t l_duration = time_us_64() - p_start_us;
 
-  /* First, send the draw commands, setting the page and column ranges. */
-  l_cmd_buffer[0] = PAGEADDR;
-  l_cmd_buffer[1] = 0;
-  l_cmd_buffer[2] = ( height / 8 ) - 1;
+  if ( stats_data.frames == 0 || l_duration < stats_data.render_min_us )
+  {
+    stats_data.render_min_us = l_duration;
+  }
+  if ( l_duration > stats_data.render_max_us )
+  {
+    stats_data.render_max_us = l_duration;
+  }
+  stats_data.render_last_us = l_duration;
+  stats_render_total_us += l_duration;
+  stats_data.frames++;
+  stats_data.dirty_fraction = (float)p_dirty_bytes / ( width * pagesize );
+  return;
+}
 
-  l_cmd_buffer[3] = COLUMNADDR;
-  l_cmd_buffer[4] = 0;
-  l_cmd_buffer[5] = width - 1;
 
-  write_cmd( PAGEADDR, 0, pagesize - 1 );
-  write_cmd( COLUMNADDR, 0, width - 1 );
+/*
+ * stats_latch_pixels; internal function, called by render on the drawing
+ *                     side, to move the count of pixels drawn since the last
+ *                     render into the stats.
+ */
 
-  /* Then, write the screen buffer with a suitable command byte. */
-  screen_buffer[0] = 0x40;
-  write_buffer( screen_buffer, screen_buffer_sz );
+void pal::SSD1306Canvas::stats_latch_pixels( void )
+{
+  stats_data.pixels_touched = stats_pixels;
+  stats_pixels = 0;
   return;
 }
 
+#endif
+
 
 /*
- * set_contrast; the contrast of the display varies from 0 to 255. Note that 
- *               this is a display-wide setting.
+ * core1_worker; renders the frames posted to it, forever. This either runs as
+ *               core1's entry point, or is called from application code on
+ *               core1.
  */
 
-void pal::SSD1306::set_contrast( uint8_t p_contrast )
+void pal::SSD1306Canvas::core1_worker( void )
 {
-  write_cmd( SETCONTRAST, p_contrast );
-  return;
+  for ( ;; )
+  {
+    core1_render( multicore_fifo_pop_blocking() );
+  }
 }
 
 
 /*
- * set_invert; sets the display to be normal (false) or inverted (true)
+ * core1_service; renders a frame if one has been posted, and returns at once
+ *                otherwise; for application code already running on core1.
+ *                Returns true if a frame was rendered.
  */
 
-void pal::SSD1306::set_invert( bool p_invert )
+bool pal::SSD1306Canvas::core1_service( void )
 {
-  /* Simple boolean choice. */
-  if ( p_invert )
+  if ( !multicore_fifo_rvalid() )
   {
-    write_cmd( INVERTDISPLAY );
+    return false;
   }
-  else
+
+  core1_render( multicore_fifo_pop_blocking() );
+  return true;
+}
+
+
+/*
+ * core1_render; internal function, run on core1, that renders the display a
+ *               frame handle refers to and hands the display back to core0.
+ */
+
+void pal::SSD1306Canvas::core1_render( uint32_t p_handle )
+{
+  SSD1306Canvas *l_display = (SSD1306Canvas *)(uintptr_t)p_handle;
+
+  l_display->core1_renderer( l_display );
+
+  /* Make sure everything is written before core0 sees we're done. */
+  __dmb();
+  l_display->core1_busy = false;
+  return;
+}
+
+
+/*
+ * wait_for_core1; internal function that waits until core1 has finished with
+ *                 the frame it was given (if any), and with it the bus.
+ */
+
+void pal::SSD1306Canvas::wait_for_core1( void )
+{
+  while ( core1_busy )
   {
-    write_cmd( NORMALDISPLAY );
+    tight_loop_contents();
   }
+  return;
+}
+
 
-  /* And we're done. */
+/*
+ * FrameMailbox::reset; starts the mailbox off with buffer 0 published (and
+ *                      not yet taken) and the producer drawing into buffer 1.
+ */
+
+void pal::FrameMailbox::reset( void )
+{
+  latest.store( 0 );
+  reading.store( 0 );
+  drawing = 1;
+  last_taken = 0xFF;
   return;
 }
 
 
+/*
+ * FrameMailbox::draw_index; returns the buffer the producer should draw in.
+ */
+
+uint8_t pal::FrameMailbox::draw_index( void )
+{
+  return drawing;
+}
+
+
+/*
+ * FrameMailbox::publish; producer side; publishes the buffer just drawn and
+ *                        returns the buffer to draw the next frame in. The
+ *                        latest value holds a sequence number above the
+ *                        buffer index, so the consumer can spot new frames.
+ */
+
+uint8_t pal::FrameMailbox::publish( void )
+{
+  uint8_t l_sequence, l_reading;
+
+  /* Publish the frame. */
+  l_sequence = ( latest.load( std::memory_order_relaxed ) >> 2 ) + 1;
+  latest.store( ( l_sequence << 2 ) | drawing );
+
+  /* And pick the buffer that's neither that nor the one being read. The   */
+  /* buffer we draw in is never the latest, so once the consumer has       */
+  /* confirmed what it's reading (see acquire) we can never pick that one. */
+  l_reading = reading.load();
+  for ( uint8_t l_index = 0; l_index < 3; l_index++ )
+  {
+    if ( l_index != drawing && l_index != l_reading )
+    {
+      drawing = l_index;
+      break;
+    }
+  }
+  return drawing;
+}
+
+
+/*
+ * FrameMailbox::acquire; consumer side; claims the newest published buffer,
+ *                        returning false if it has already been taken. The
+ *                        claim is re-checked against latest, in case the
+ *                        producer published (and picked a new buffer) in
+ *                        between; this only loops if the producer publishes
+ *                        again within those few instructions.
+ */
+
+bool pal::FrameMailbox::acquire( uint8_t *p_index )
+{
+  uint8_t l_latest;
+
+  do
+  {
+    l_latest = latest.load();
+    reading.store( l_latest & 0x03 );
+  } while ( latest.load() != l_latest );
+
+  /* Let the caller know if this is a new frame. */
+  *p_index = l_latest & 0x03;
+  if ( l_latest == last_taken )
+  {
+    return false;
+  }
+  last_taken = l_latest;
+  return true;
+}
+
+
 /*
  * set_pixel; basic drawing primitive; turns on the pixel at the specified
  *            location in the screen buffer.
  */
 
-void pal::SSD1306::set_pixel( uint8_t p_x, uint8_t p_y )
+void pal::SSD1306Canvas::set_pixel( uint8_t p_x, uint8_t p_y )
 {
   /* Sanity check the co-ordinates. */
   if ( p_x >= width | p_y >= height )
@@ -230,6 +549,10 @@ void pal::SSD1306::set_pixel( uint8_t p_x, uint8_t p_y )
 
   /* Good, so just set the bit in the buffer. */
   screen_ptr[(width*(p_y>>3))+p_x] |= 0x01<<(p_y&0x07);
+
+  /* And widen the dirty window on this page to include it. */
+  mark_dirty( p_y>>3, p_x );
+  SSD1306_STAT( stats_pixels++ );
   return;
 }
 
@@ -239,7 +562,7 @@ void pal::SSD1306::set_pixel( uint8_t p_x, uint8_t p_y )
  *              location in the screen buffer.
  */
 
-void pal::SSD1306::clear_pixel( uint8_t p_x, uint8_t p_y )
+void pal::SSD1306Canvas::clear_pixel( uint8_t p_x, uint8_t p_y )
 {
   /* Sanity check the co-ordinates. */
   if ( p_x >= width | p_y >= height )
@@ -249,69 +572,125 @@ void pal::SSD1306::clear_pixel( uint8_t p_x, uint8_t p_y )
 
   /* Good, so just set the bit in the buffer. */
   screen_ptr[(width*(p_y>>3))+p_x] &= ~(0x01<<(p_y&0x07));
+
+  /* And widen the dirty window on this page to include it. */
+  mark_dirty( p_y>>3, p_x );
+  SSD1306_STAT( stats_pixels++ );
   return;
 }
 
 
 /*
  * draw_line; draws a straight line between two provided points; the line
- *            includes both these points.
+ *            includes both these points. Horizontal and vertical lines are
+ *            handed to draw_hline and draw_vline, and anything else is
+ *            traced a pixel at a time.
  */
 
-void pal::SSD1306::draw_line( uint8_t p_x1, uint8_t p_y1, uint8_t p_x2, uint8_t p_y2, bool p_set )
+void pal::SSD1306Canvas::draw_line( uint8_t p_x1, uint8_t p_y1, uint8_t p_x2, uint8_t p_y2, bool p_set )
 {
-  int16_t l_dx, l_dy, l_sx, l_sy;
-  int16_t l_err, l_e2;
-  uint8_t l_x, l_y;
-
-  /* Work out the deltas and slopes. */
-  l_dx = abs( p_x2 - p_x1 );
-  l_dy = abs( p_y2 - p_y1 ) * -1;
-
-  l_sx = ( p_x1 < p_x2 ) ? 1 : -1;
-  l_sy = ( p_y1 < p_y2 ) ? 1 : -1;
+  uint8_t l_start;
+  int16_t l_length;
 
-  /* Set the initial error, and the initial pixel. */
-  l_err = l_dx + l_dy;
-  l_x = p_x1;
-  l_y = p_y1;
-
-  /* Now loop until we hit the final pixel. */
-  while( true )
+  /* Lines along a row or column can be drawn a byte at a time; a line can */
+  /* be 256 pixels long, so its length is clipped to the screen before it  */
+  /* is narrowed to fit draw_hline or draw_vline.                          */
+  if ( p_y1 == p_y2 )
   {
-    /* Draw the current pixel. */
-    if ( p_set )
+    l_start = ( p_x1 < p_x2 ) ? p_x1 : p_x2;
+    l_length = abs( p_x2 - p_x1 ) + 1;
+    if ( l_start < width )
     {
-      set_pixel( l_x, l_y );
+      if ( l_length > width - l_start )
+      {
+        l_length = width - l_start;
+      }
+      draw_hline( l_start, p_y1, (uint8_t)l_length, p_set ? DRAW_SET : DRAW_CLEAR );
     }
-    else
+    return;
+  }
+  if ( p_x1 == p_x2 )
+  {
+    l_start = ( p_y1 < p_y2 ) ? p_y1 : p_y2;
+    l_length = abs( p_y2 - p_y1 ) + 1;
+    if ( l_start < height )
     {
-      clear_pixel( l_x, l_y );
+      if ( l_length > height - l_start )
+      {
+        l_length = height - l_start;
+      }
+      draw_vline( p_x1, l_start, (uint8_t)l_length, p_set ? DRAW_SET : DRAW_CLEAR );
     }
+    return;
+  }
 
-    /* End if that was the end of the line. */
-    if ( l_x == p_x2 && l_y == p_y2 )
-    {
-      break;
-    }
+  trace_line( this, p_x1, p_y1, p_x2, p_y2, p_set );
+  return;
+}
 
-    /* Work out the next step. */
-    l_e2 = l_err * 2;
 
-    if ( l_e2 >= l_dy )
-    {
-      l_err += l_dy;
-      l_x += l_sx;
-    }
+/*
+ * draw_hline; draws a horizontal line, width pixels long, rightwards from the
+ *             given point; it's a single bit mask applied across a run of
+ *             bytes in one page.
+ */
+
+void pal::SSD1306Canvas::draw_hline( uint8_t p_x, uint8_t p_y, uint8_t p_width, ssd1306_draw_mode_t p_mode )
+{
+  uint8_t l_last_x;
+
+  if ( p_width == 0 || p_x >= width || p_y >= height )
+  {
+    return;
+  }
+  l_last_x = ( p_x + p_width > width ) ? width - 1 : p_x + p_width - 1;
 
-    if ( l_e2 <= l_dx )
+  apply_mask_run( screen_ptr + ( width * ( p_y >> 3 ) ) + p_x, l_last_x - p_x + 1, 0x01 << ( p_y & 0x07 ), p_mode );
+  mark_dirty( p_y >> 3, p_x );
+  mark_dirty( p_y >> 3, l_last_x );
+
+  SSD1306_STAT( stats_pixels += l_last_x - p_x + 1 );
+  return;
+}
+
+
+/*
+ * draw_vline; draws a vertical line, height pixels long, downwards from the
+ *             given point; it's a single byte write on each page, masked at
+ *             the ends.
+ */
+
+void pal::SSD1306Canvas::draw_vline( uint8_t p_x, uint8_t p_y, uint8_t p_height, ssd1306_draw_mode_t p_mode )
+{
+  uint8_t  l_last_y, l_last_page;
+  uint8_t  l_mask;
+  uint8_t *l_byte;
+
+  if ( p_height == 0 || p_x >= width || p_y >= height )
+  {
+    return;
+  }
+  l_last_y = ( p_y + p_height > height ) ? height - 1 : p_y + p_height - 1;
+  l_last_page = l_last_y >> 3;
+
+  /* The first page is masked from the top of the line down... */
+  l_byte = screen_ptr + ( width * ( p_y >> 3 ) ) + p_x;
+  l_mask = 0xFF << ( p_y & 0x07 );
+  for ( uint8_t l_page = p_y >> 3; l_page <= l_last_page; l_page++ )
+  {
+    /* ...and the last from the bottom of it up. */
+    if ( l_page == l_last_page )
     {
-      l_err += l_dx;
-      l_y += l_sy;
+      l_mask &= 0xFF >> ( 7 - ( l_last_y & 0x07 ) );
     }
+    apply_mask( l_byte, l_mask, p_mode );
+    mark_dirty( l_page, p_x );
+
+    l_byte += width;
+    l_mask = 0xFF;
   }
 
-  /* All done. */
+  SSD1306_STAT( stats_pixels += l_last_y - p_y + 1 );
   return;
 }
 
@@ -321,16 +700,15 @@ void pal::SSD1306::draw_line( uint8_t p_x1, uint8_t p_y1, uint8_t p_x2, uint8_t
  *           just an outline, or filled in.
  */
 
-void pal::SSD1306::draw_box( uint8_t p_x, uint8_t p_y, uint8_t p_width, uint8_t p_height, bool p_filled, bool p_set )
+void pal::SSD1306Canvas::draw_box( uint8_t p_x, uint8_t p_y, uint8_t p_width, uint8_t p_height, bool p_filled, bool p_set )
 {
   /* We do things differently depending on whether or not we're filled. */
   if ( p_filled )
   {
-    /* Draw a line for each row, to produce a filled box. */
-    for( uint8_t l_index = p_y+p_height+1; l_index > p_y; l_index-- )
-    {
-      draw_line( p_x, l_index-1, p_x + p_width, l_index-1 );
-    }
+    /* The box includes both edges, so it's a pixel wider (and taller) */
+    /* than the dimensions given.                                      */
+    fill_rect( p_x, p_y, ( p_width < 0xFF ) ? p_width + 1 : 0xFF, ( p_height < 0xFF ) ? p_height + 1 : 0xFF,
+               p_set ? DRAW_SET : DRAW_CLEAR );
   }
   else
   {
@@ -347,151 +725,484 @@ void pal::SSD1306::draw_box( uint8_t p_x, uint8_t p_y, uint8_t p_width, uint8_t
 
 
 /*
- * draw_char; draws a single character at the specified location. 
- */
-
-void pal::SSD1306::draw_char( uint8_t p_x, uint8_t p_y, char p_char, bool p_set )
-{
-  static uint8_t l_font[][5] = {
-    { 0b0000000, 0b0000000, 0b0000000, 0b0000000, 0b0000000 }, // space
-    { 0b0000000, 0b0000000, 0b1111101, 0b0000000, 0b0000000 }, // !
-    { 0b0000000, 0b1110000, 0b0000000, 0b1110000, 0b0000000 }, // "
-    { 0b0010100, 0b1111111, 0b0010100, 0b1111111, 0b0010100 }, // #
-    { 0b0010010, 0b0101010, 0b1111111, 0b0101010, 0b0100100 }, // $
-    { 0b1100010, 0b1100100, 0b0001000, 0b0010011, 0b0100011 }, // %
-    { 0b0110110, 0b1001001, 0b1010101, 0b0100010, 0b0000101 }, // &
-    { 0b0000000, 0b0000000, 0b1100000, 0b0000000, 0b0000000 }, // ’
-    { 0b0000000, 0b0011100, 0b0100010, 0b1000001, 0b0000000 }, // (
-    { 0b0000000, 0b1000001, 0b0100010, 0b0011100, 0b0000000 }, // )
-    { 0b0010100, 0b0001000, 0b0111110, 0b0001000, 0b0010100 }, // *
-    { 0b0001000, 0b0001000, 0b0111110, 0b0001000, 0b0001000 }, // +
-    { 0b0000000, 0b0000101, 0b0000110, 0b0000000, 0b0000000 }, // ,
-    { 0b0001000, 0b0001000, 0b0001000, 0b0001000, 0b0001000 }, // -
-    { 0b0000000, 0b0000011, 0b0000011, 0b0000000, 0b0000000 }, // .
-    { 0b0000010, 0b0000100, 0b0001000, 0b0010000, 0b0100000 }, // /
-    { 0b0111110, 0b1000101, 0b1001001, 0b1010001, 0b0111110 }, // 0
-    { 0b0000000, 0b0100001, 0b1111111, 0b0000001, 0b0000000 }, // 1
-    { 0b0100011, 0b1000101, 0b1001001, 0b1001001, 0b0110001 }, // 2
-    { 0b0100010, 0b1000001, 0b1001001, 0b1001001, 0b0110110 }, // 3
-    { 0b0001100, 0b0010100, 0b0100100, 0b1111111, 0b0000100 }, // 4
-    { 0b1110010, 0b1010001, 0b1010001, 0b1010001, 0b1001110 }, // 5
-    { 0b0011110, 0b0101001, 0b1001001, 0b1001001, 0b0000110 }, // 6
-    { 0b1000000, 0b1000111, 0b1001000, 0b1010000, 0b1100000 }, // 7
-    { 0b0110110, 0b1001001, 0b1001001, 0b1001001, 0b0110110 }, // 8
-    { 0b0110000, 0b1001001, 0b1001001, 0b1001010, 0b0111100 }, // 9
-    { 0b0000000, 0b0110110, 0b0110110, 0b0000000, 0b0000000 }, // :
-    { 0b0000000, 0b0110101, 0b0110110, 0b0000000, 0b0000000 }, // ;
-    { 0b0001000, 0b0010100, 0b0100010, 0b1000001, 0b0000000 }, // <
-    { 0b0010100, 0b0010100, 0b0010100, 0b0010100, 0b0010100 }, // =
-    { 0b0000000, 0b1000001, 0b0100010, 0b0010100, 0b0001000 }, // >
-    { 0b0100000, 0b1000000, 0b1000101, 0b1001000, 0b0110000 }, // ?
-    { 0b0100110, 0b1001001, 0b1001111, 0b1000001, 0b0111110 }, // @
-    { 0b0011111, 0b0100100, 0b1000100, 0b0100100, 0b0011111 }, // A
-    { 0b1000001, 0b1111111, 0b1001001, 0b1001001, 0b0110110 }, // B
-    { 0b0111110, 0b1000001, 0b1000001, 0b1000001, 0b0100010 }, // C
-    { 0b1000001, 0b1111111, 0b1000001, 0b1000001, 0b0111110 }, // D
-    { 0b1111111, 0b1001001, 0b1001001, 0b1001001, 0b1000001 }, // E
-    { 0b1111111, 0b1001000, 0b1001000, 0b1001000, 0b1000000 }, // F
-    { 0b0111110, 0b1000001, 0b1000001, 0b1001001, 0b0101111 }, // G
-    { 0b1111111, 0b0001000, 0b0001000, 0b0001000, 0b1111111 }, // H
-    { 0b0000000, 0b1000001, 0b1111111, 0b1000001, 0b0000000 }, // I
-    { 0b0000010, 0b0000001, 0b1000001, 0b1111110, 0b1000000 }, // J
-    { 0b1111111, 0b0001000, 0b0010100, 0b0100010, 0b1000001 }, // K
-    { 0b1111111, 0b0000001, 0b0000001, 0b0000001, 0b0000001 }, // L
-    { 0b1111111, 0b0100000, 0b0011000, 0b0100000, 0b1111111 }, // M
-    { 0b1111111, 0b0010000, 0b0001000, 0b0000100, 0b1111111 }, // N
-    { 0b0111110, 0b1000001, 0b1000001, 0b1000001, 0b0111110 }, // O
-    { 0b1111111, 0b1001000, 0b1001000, 0b1001000, 0b0110000 }, // P
-    { 0b0111110, 0b1000001, 0b1000101, 0b1000010, 0b0111101 }, // Q
-    { 0b1111111, 0b1001000, 0b1001100, 0b1001010, 0b0110001 }, // R
-    { 0b0110010, 0b1001001, 0b1001001, 0b1001001, 0b0100110 }, // S
-    { 0b1000000, 0b1000000, 0b1111111, 0b1000000, 0b1000000 }, // T
-    { 0b1111110, 0b0000001, 0b0000001, 0b0000001, 0b1111110 }, // U
-    { 0b1111100, 0b0000010, 0b0000001, 0b0000010, 0b1111100 }, // V
-    { 0b1111110, 0b0000001, 0b0001110, 0b0000001, 0b1111110 }, // W
-    { 0b1100011, 0b0010100, 0b0001000, 0b0010100, 0b1100011 }, // X
-    { 0b1110000, 0b0001000, 0b0000111, 0b0001000, 0b1110000 }, // Y
-    { 0b1000011, 0b1000101, 0b1001001, 0b1010001, 0b1100001 }, // Z
-    { 0b0000000, 0b1111111, 0b1000001, 0b1000001, 0b0000000 }, // [
-    { 0b0100000, 0b0010000, 0b0001000, 0b0000100, 0b0000010 }, // backslash
-    { 0b0000000, 0b1000001, 0b1000001, 0b1111111, 0b0000000 }, // ]
-    { 0b0010000, 0b0100000, 0b1000000, 0b0100000, 0b0010000 }, // ^
-    { 0b0000001, 0b0000001, 0b0000001, 0b0000001, 0b0000001 }, // _
-    { 0b0000000, 0b1000000, 0b0100000, 0b0010000, 0b0000000 }, // `
-    { 0b0000010, 0b0010101, 0b0010101, 0b0010101, 0b0001111 }, // a
-    { 0b1111111, 0b0001001, 0b0010001, 0b0010001, 0b0001110 }, // b
-    { 0b0001110, 0b0010001, 0b0010001, 0b0010001, 0b0000010 }, // c
-    { 0b0001110, 0b0010001, 0b0010001, 0b0001001, 0b1111111 }, // d
-    { 0b0001110, 0b0010101, 0b0010101, 0b0010101, 0b0001100 }, // e
-    { 0b0001000, 0b0111111, 0b1001000, 0b1000000, 0b0100000 }, // f
-    { 0b0001000, 0b0010101, 0b0010101, 0b0010101, 0b0011110 }, // g
-    { 0b1111111, 0b0001000, 0b0010000, 0b0010000, 0b0001111 }, // h
-    { 0b0000000, 0b0001001, 0b1011111, 0b0000001, 0b0000000 }, // i
-    { 0b0000010, 0b0000001, 0b0010001, 0b1011110, 0b0000000 }, // j
-    { 0b1111111, 0b0000100, 0b0001010, 0b0010001, 0b0000000 }, // k
-    { 0b0000000, 0b1000001, 0b1111111, 0b0000001, 0b0000000 }, // l
-    { 0b0011111, 0b0010000, 0b0001111, 0b0010000, 0b0001111 }, // m
-    { 0b0011111, 0b0001000, 0b0010000, 0b0010000, 0b0001111 }, // n
-    { 0b0001110, 0b0010001, 0b0010001, 0b0010001, 0b0001110 }, // o
-    { 0b0011111, 0b0010100, 0b0010100, 0b0010100, 0b0001000 }, // p
-    { 0b0001000, 0b0010100, 0b0010100, 0b0001100, 0b0011111 }, // q
-    { 0b0011111, 0b0001000, 0b0010000, 0b0010000, 0b0001000 }, // r
-    { 0b0001001, 0b0010101, 0b0010101, 0b0010101, 0b0000010 }, // s
-    { 0b0010000, 0b1111110, 0b0010001, 0b0000001, 0b0000010 }, // t
-    { 0b0011110, 0b0000001, 0b0000001, 0b0000010, 0b0011111 }, // u
-    { 0b0011100, 0b0000010, 0b0000001, 0b0000010, 0b0011100 }, // v
-    { 0b0011110, 0b0000001, 0b0000110, 0b0000001, 0b0011110 }, // w
-    { 0b0010001, 0b0001010, 0b0000100, 0b0001010, 0b0010001 }, // x
-    { 0b0011000, 0b0000101, 0b0000101, 0b0000101, 0b0011110 }, // y
-    { 0b0010001, 0b0010011, 0b0010101, 0b0011001, 0b0010001 }, // z
-    { 0b0000000, 0b0001000, 0b0110110, 0b1000001, 0b0000000 }, // {
-    { 0b0000000, 0b0000000, 0b1111111, 0b0000000, 0b0000000 }, // |
-    { 0b0000000, 0b1000001, 0b0110110, 0b0001000, 0b0000000 }, // }
-    { 0b0000100, 0b0001000, 0b0001000, 0b0000100, 0b0001000 }, // ~
-    { 0b0000110, 0b0001001, 0b1010001, 0b0000001, 0b0000010 }  // undef
-  };
-
-  uint8_t l_char = ( p_char < 0x20 || p_char > 0x7E ) ? 0x7F : p_char - 0x20;
-
-  /* So, each character is a simple 5x7 font grid. */
-  for( uint8_t l_x = 0; l_x < 5; l_x++ )
-  {
-    for( uint8_t l_y = 0; l_y < 7; l_y++ )
+ * fill_rect; fills a rectangle of the given width and height, setting,
+ *            clearing or flipping every pixel in it. Each page it covers is
+ *            worked on a byte at a time, with masks for the partial pages at
+ *            the top and bottom.
+ */
+
+void pal::SSD1306Canvas::fill_rect( uint8_t p_x, uint8_t p_y, uint8_t p_width, uint8_t p_height, ssd1306_draw_mode_t p_mode )
+{
+  uint8_t l_last_x, l_last_y;
+  uint8_t l_first_page, l_last_page;
+  uint8_t l_mask;
+
+  /* Nothing to do for an empty area, or one off the screen. */
+  if ( p_width == 0 || p_height == 0 || p_x >= width || p_y >= height )
+  {
+    return;
+  }
+
+  /* Clip the area to the display. */
+  l_last_x = ( p_x + p_width > width ) ? width - 1 : p_x + p_width - 1;
+  l_last_y = ( p_y + p_height > height ) ? height - 1 : p_y + p_height - 1;
+  l_first_page = p_y >> 3;
+  l_last_page = l_last_y >> 3;
+
+  /* Work down the pages, masking off rows outside the area on the first */
+  /* and last of them.                                                   */
+  for ( uint8_t l_page = l_first_page; l_page <= l_last_page; l_page++ )
+  {
+    l_mask = 0xFF;
+    if ( l_page == l_first_page )
+    {
+      l_mask &= 0xFF << ( p_y & 0x07 );
+    }
+    if ( l_page == l_last_page )
+    {
+      l_mask &= 0xFF >> ( 7 - ( l_last_y & 0x07 ) );
+    }
+
+    apply_mask_run( screen_ptr + ( width * l_page ) + p_x, l_last_x - p_x + 1, l_mask, p_mode );
+    mark_dirty( l_page, p_x );
+    mark_dirty( l_page, l_last_x );
+  }
+
+  SSD1306_STAT( stats_pixels += ( l_last_x - p_x + 1 ) * ( l_last_y - p_y + 1 ) );
+  return;
+}
+
+
+/*
+ * unpack_glyph; internal function which unpacks a run length packed glyph
+ *               (see pal-ssd1306-font.h).
+ */
+
+static void unpack_glyph( const uint8_t *p_packed, uint8_t *p_unpacked, size_t p_length )
+{
+  uint8_t l_control, l_count;
+
+  while ( p_length > 0 )
+  {
+    l_control = *p_packed++;
+    if ( l_control & 0x80 )
     {
-      /* If the bit is set, draw the pixel. */
-      if ( ( 0x01 << ( 6 - l_y ) ) & l_font[l_char][l_x] )
+      /* A run of the same byte... */
+      for ( l_count = ( l_control & 0x7F ) + 2; l_count > 0 && p_length > 0; l_count--, p_length-- )
       {
-        if ( p_set )
-        {
-          set_pixel( p_x + l_x, p_y + l_y );
-        }
-        else
-        {
-          clear_pixel( p_x + l_x, p_y + l_y );          
-        }
+        *p_unpacked++ = *p_packed;
+      }
+      p_packed++;
+    }
+    else
+    {
+      /* ...or of bytes to copy as they are. */
+      for ( l_count = l_control + 1; l_count > 0 && p_length > 0; l_count--, p_length-- )
+      {
+        *p_unpacked++ = *p_packed++;
+      }
+    }
+  }
+  return;
+}
+
+
+/*
+ * find_glyph; internal function which finds a character in a font, returning
+ *             its columns (or nullptr if the font has nothing to draw for
+ *             it), and its index, width and advance. Packed glyphs are
+ *             unpacked into the buffer, if one is given.
+ */
+
+static const uint8_t *find_glyph( const pal::Font &p_font, char p_char, uint8_t *p_buffer,
+                                  uint8_t *p_index, uint8_t *p_width, uint8_t *p_advance )
+{
+  size_t l_length;
+
+  uint8_t l_code = (uint8_t)p_char;
+
+  /* Anything the font doesn't cover is drawn as its fallback. */
+  if ( l_code < p_font.first || l_code > p_font.last )
+  {
+    l_code = p_font.fallback;
+    if ( l_code < p_font.first || l_code > p_font.last )
+    {
+      return nullptr;
+    }
+  }
+  *p_index = l_code - p_font.first;
+
+  /* Fixed width glyphs just follow each other; proportional ones are listed. */
+  if ( p_font.glyphs == nullptr )
+  {
+    *p_width = p_font.width;
+    *p_advance = p_font.advance;
+    return p_font.bitmap + ( *p_index * p_font.width * ( ( p_font.height + 7 ) / 8 ) );
+  }
+  *p_width = p_font.glyphs[*p_index].width;
+  *p_advance = p_font.glyphs[*p_index].advance;
+  if ( ( p_font.flags & SSD1306_FONT_RLE ) == 0 || p_buffer == nullptr )
+  {
+    return p_font.bitmap + p_font.glyphs[*p_index].offset;
+  }
+
+  /* Packed glyphs must be unpacked before they can be drawn. */
+  l_length = *p_width * ( ( p_font.height + 7 ) / 8 );
+  if ( l_length > SSD1306_FONT_MAX_UNPACKED )
+  {
+    return nullptr;
+  }
+  unpack_glyph( p_font.bitmap + p_font.glyphs[*p_index].offset, p_buffer, l_length );
+  return p_buffer;
+}
+
+
+/*
+ * shift_columns; internal function which shifts glyph columns down by up to
+ *                seven rows, into a pair of bytes each: the part that lands
+ *                in the glyph's first page, and the part that spills into
+ *                the next.
+ */
+
+static void shift_columns( const uint8_t *p_columns, uint8_t p_width, uint8_t p_shift, uint8_t *p_shifted )
+{
+  for( uint8_t l_x = 0; l_x < p_width; l_x++ )
+  {
+    *p_shifted++ = p_columns[l_x] << p_shift;
+    *p_shifted++ = ( (uint16_t)p_columns[l_x] << p_shift ) >> 8;
+  }
+  return;
+}
+
+
+/*
+ * page_clip; returns the rows of a page that are on the display - all of
+ *            them, except on the last page of a display whose height isn't
+ *            a whole number of pages, and none past the last page.
+ */
+
+uint8_t pal::SSD1306Canvas::page_clip( uint16_t p_page )
+{
+  if ( p_page >= pagesize )
+  {
+    return 0x00;
+  }
+  return ( p_page * 8 + 8 > height ) ? 0xFF >> ( p_page * 8 + 8 - height ) : 0xFF;
+}
+
+
+/*
+ * blit_glyph; internal function which draws a glyph a page tall, given as
+ *             columns already shifted to its row (see shift_columns). Each
+ *             column goes into the page holding the glyph's top row and the
+ *             one below it; so it's at most two masked byte writes, whatever
+ *             the glyph.
+ */
+
+void pal::SSD1306Canvas::blit_glyph( uint8_t p_x, uint8_t p_y, const uint8_t *p_shifted, uint8_t p_width, ssd1306_draw_mode_t p_mode )
+{
+  uint8_t  l_page, l_last_x;
+  uint8_t  l_top_clip, l_bottom_clip;
+  uint8_t  l_top, l_bottom;
+  uint8_t *l_byte;
+
+  if ( p_width == 0 || p_x >= width || p_y >= height )
+  {
+    return;
+  }
+  l_last_x = ( p_x + p_width > width ) ? width - 1 : p_x + p_width - 1;
+  l_page = p_y >> 3;
+
+  /* Rows beyond the bottom of the display must be left alone. */
+  l_top_clip = page_clip( l_page );
+  l_bottom_clip = page_clip( l_page + 1 );
+
+  l_byte = screen_ptr + ( width * l_page ) + p_x;
+  for ( uint8_t l_x = p_x; l_x <= l_last_x; l_x++, l_byte++ )
+  {
+    l_top = *p_shifted++ & l_top_clip;
+    l_bottom = *p_shifted++ & l_bottom_clip;
+
+    /* Blank columns (and blank halves) are skipped, dirtying nothing. */
+    if ( l_top != 0 )
+    {
+      apply_mask( l_byte, l_top, p_mode );
+      mark_dirty( l_page, l_x );
+    }
+    if ( l_bottom != 0 )
+    {
+      apply_mask( l_byte + width, l_bottom, p_mode );
+      mark_dirty( l_page + 1, l_x );
+    }
+    SSD1306_STAT( stats_pixels += __builtin_popcount( l_top ) + __builtin_popcount( l_bottom ) );
+  }
+  return;
+}
+
+
+/*
+ * blit_bitmap; internal function which draws a glyph straight from a font's
+ *              bitmap, any number of pages tall; each page of each column
+ *              is shifted to the glyph's row as it goes, landing in two
+ *              pages of the screen buffer just as in blit_glyph.
+ */
+
+void pal::SSD1306Canvas::blit_bitmap( uint8_t p_x, uint8_t p_y, const uint8_t *p_bitmap, uint8_t p_width, uint8_t p_pages, ssd1306_draw_mode_t p_mode )
+{
+  uint8_t  l_page, l_shift, l_last_x;
+  uint8_t  l_top, l_bottom;
+  uint8_t *l_byte;
+
+  if ( p_width == 0 || p_x >= width || p_y >= height )
+  {
+    return;
+  }
+  l_last_x = ( p_x + p_width > width ) ? width - 1 : p_x + p_width - 1;
+  l_shift = p_y & 0x07;
+
+  /* Work down the glyph a page at a time, for as long as it's on screen. */
+  for ( uint8_t l_glyph_page = 0; l_glyph_page < p_pages; l_glyph_page++ )
+  {
+    l_page = ( p_y >> 3 ) + l_glyph_page;
+    if ( l_page >= pagesize )
+    {
+      break;
+    }
+
+    l_byte = screen_ptr + ( width * l_page ) + p_x;
+    for ( uint8_t l_x = p_x; l_x <= l_last_x; l_x++, l_byte++ )
+    {
+      l_top = ( p_bitmap[( l_x - p_x ) * p_pages + l_glyph_page] << l_shift ) & page_clip( l_page );
+      l_bottom = ( p_bitmap[( l_x - p_x ) * p_pages + l_glyph_page] >> ( 8 - l_shift ) ) & page_clip( l_page + 1 );
+
+      if ( l_top != 0 )
+      {
+        apply_mask( l_byte, l_top, p_mode );
+        mark_dirty( l_page, l_x );
+      }
+      if ( l_bottom != 0 )
+      {
+        apply_mask( l_byte + width, l_bottom, p_mode );
+        mark_dirty( l_page + 1, l_x );
       }
+      SSD1306_STAT( stats_pixels += __builtin_popcount( l_top ) + __builtin_popcount( l_bottom ) );
+    }
+  }
+  return;
+}
+
+
+/*
+ * glyph_cache_for; internal function which finds the glyph cache slot for
+ *                  the given font and row offset. If there isn't one, the
+ *                  slot used least recently is emptied and given over to it.
+ */
+
+pal::ssd1306_glyph_cache_t *pal::SSD1306Canvas::glyph_cache_for( const Font &p_font, uint8_t p_shift )
+{
+  ssd1306_glyph_cache_t *l_slot = &glyph_cache[0];
+
+  /* Every lookup moves the clock on, and stamps the slot it finds. */
+  glyph_cache_clock++;
+  for ( uint8_t l_index = 0; l_index < glyph_cache_slots; l_index++ )
+  {
+    if ( glyph_cache[l_index].font == &p_font && glyph_cache[l_index].shift == p_shift )
+    {
+      glyph_cache[l_index].used = glyph_cache_clock;
+      return &glyph_cache[l_index];
+    }
+
+    /* Otherwise look for an empty slot, or the one stamped longest ago; */
+    /* measured back from now, so that the clock can wrap.               */
+    if ( l_slot->font != nullptr &&
+         ( glyph_cache[l_index].font == nullptr ||
+           glyph_cache_clock - glyph_cache[l_index].used > glyph_cache_clock - l_slot->used ) )
+    {
+      l_slot = &glyph_cache[l_index];
     }
   }
 
+  l_slot->used = glyph_cache_clock;
+  l_slot->font = &p_font;
+  l_slot->shift = p_shift;
+  memset( l_slot->valid, 0, sizeof( l_slot->valid ) );
+  return l_slot;
+}
+
+
+/*
+ * enable_glyph_cache; keeps glyphs shifted for the rows draw_text is drawing
+ *                     on, so that each is shifted only once rather than
+ *                     every time it is drawn. Each slot holds one font at one
+ *                     row offset (y & 7), filled in as glyphs are used; the
+ *                     slots can be provided, or are allocated. Only fonts a
+ *                     page tall, and no more than SSD1306_CACHE_WIDTH wide,
+ *                     are cached.
+ */
+
+bool pal::SSD1306Canvas::enable_glyph_cache( uint8_t p_slots, ssd1306_glyph_cache_t *p_cache )
+{
+  /* Nothing to do if we're already set up. */
+  if ( glyph_cache != nullptr )
+  {
+    return true;
+  }
+  if ( p_slots == 0 )
+  {
+    return false;
+  }
+
+  /* Allocate the slots, unless we've been given them. */
+  owns_glyph_cache = ( p_cache == nullptr );
+  glyph_cache = owns_glyph_cache ? new ssd1306_glyph_cache_t[p_slots] : p_cache;
+  if ( glyph_cache == nullptr )
+  {
+    return false;
+  }
+
+  /* And start with them all empty. */
+  for ( uint8_t l_index = 0; l_index < p_slots; l_index++ )
+  {
+    glyph_cache[l_index].font = nullptr;
+    glyph_cache[l_index].used = 0;
+  }
+  glyph_cache_slots = p_slots;
+  glyph_cache_clock = 0;
+  return true;
+}
+
+
+/*
+ * draw_char; draws a single character at the specified location, in the
+ *            built in 5x7 font.
+ */
+
+void pal::SSD1306Canvas::draw_char( uint8_t p_x, uint8_t p_y, char p_char, bool p_set )
+{
+  draw_char( p_x, p_y, p_char, font_5x7, p_set ? DRAW_SET : DRAW_CLEAR );
+  return;
+}
+
+
+/*
+ * draw_char; draws a single character at the specified location, in the
+ *            built in 5x7 font, setting, clearing or flipping the pixels of
+ *            the glyph.
+ */
+
+void pal::SSD1306Canvas::draw_char( uint8_t p_x, uint8_t p_y, char p_char, ssd1306_draw_mode_t p_mode )
+{
+  draw_char( p_x, p_y, p_char, font_5x7, p_mode );
+  return;
+}
+
+
+/*
+ * draw_char; draws a single character at the specified location, in the
+ *            given font, setting, clearing or flipping the pixels of the
+ *            glyph.
+ */
+
+void pal::SSD1306Canvas::draw_char( uint8_t p_x, uint8_t p_y, char p_char, const Font &p_font, ssd1306_draw_mode_t p_mode )
+{
+  const uint8_t *l_bitmap;
+  uint8_t        l_index, l_width, l_advance;
+  uint8_t        l_unpacked[SSD1306_FONT_MAX_UNPACKED];
+
+  l_bitmap = find_glyph( p_font, p_char, l_unpacked, &l_index, &l_width, &l_advance );
+  if ( l_bitmap != nullptr )
+  {
+    blit_bitmap( p_x, p_y, l_bitmap, l_width, ( p_font.height + 7 ) / 8, p_mode );
+  }
+
   /* All done. */
   return;
 }
 
 
 /*
- * draw_text; draws a text string at the specified location. Note that text
- *            does not wrap!
+ * draw_text; draws a text string at the specified location, in the built in
+ *            5x7 font. Note that text does not wrap!
+ */
+
+void pal::SSD1306Canvas::draw_text( uint8_t p_x, uint8_t p_y, const char *p_text, bool p_set )
+{
+  draw_text( p_x, p_y, p_text, font_5x7, p_set ? DRAW_SET : DRAW_CLEAR );
+  return;
+}
+
+
+/*
+ * draw_text; draws a text string at the specified location, in the built in
+ *            5x7 font, setting, clearing or flipping the pixels of each
+ *            glyph.
+ */
+
+void pal::SSD1306Canvas::draw_text( uint8_t p_x, uint8_t p_y, const char *p_text, ssd1306_draw_mode_t p_mode )
+{
+  draw_text( p_x, p_y, p_text, font_5x7, p_mode );
+  return;
+}
+
+
+/*
+ * draw_text; draws a text string at the specified location, in the given
+ *            font, setting, clearing or flipping the pixels of each glyph.
+ *            The text stops at the right hand edge of the display.
  */
 
-void pal::SSD1306::draw_text( uint8_t p_x, uint8_t p_y, const char *p_text, bool p_set )
+void pal::SSD1306Canvas::draw_text( uint8_t p_x, uint8_t p_y, const char *p_text, const Font &p_font, ssd1306_draw_mode_t p_mode )
 {
-  size_t l_strlen;
+  ssd1306_glyph_cache_t *l_cache = nullptr;
+  const uint8_t         *l_bitmap;
+  uint8_t                l_index, l_width, l_advance;
+  uint8_t                l_unpacked[SSD1306_FONT_MAX_UNPACKED];
+  uint8_t               *l_shifted;
+  uint16_t               l_x = p_x;
+
+  /* Glyphs a page tall can come from the cache, if there is one. */
+  if ( glyph_cache != nullptr && p_font.height <= 8 )
+  {
+    l_cache = glyph_cache_for( p_font, p_y & 0x07 );
+  }
 
   /* Work through the string, one character at a time. */
-  l_strlen = strlen( p_text );
-  for ( size_t l_index = 0; l_index < l_strlen; l_index++ )
+  for ( const char *l_char = p_text; *l_char != '\0' && l_x < width; l_char++ )
   {
-    draw_char( p_x + (l_index * 6), p_y, p_text[l_index], p_set );
+    /* Find the glyph, but leave unpacking it until it's needed; a glyph */
+    /* that's already in the cache never is.                            */
+    l_bitmap = find_glyph( p_font, *l_char, nullptr, &l_index, &l_width, &l_advance );
+    if ( l_bitmap == nullptr )
+    {
+      continue;
+    }
+
+    if ( l_cache != nullptr && l_index < SSD1306_CACHE_GLYPHS && l_width <= SSD1306_CACHE_WIDTH )
+    {
+      /* Each glyph is shifted the first time it's drawn on this row */
+      /* offset, and just copied in after that.                       */
+      l_shifted = l_cache->columns[l_index];
+      if ( ( l_cache->valid[l_index >> 3] & ( 0x01 << ( l_index & 0x07 ) ) ) == 0 )
+      {
+        l_bitmap = find_glyph( p_font, *l_char, l_unpacked, &l_index, &l_width, &l_advance );
+        if ( l_bitmap == nullptr )
+        {
+          continue;
+        }
+        shift_columns( l_bitmap, l_width, p_y & 0x07, l_shifted );
+        l_cache->valid[l_index >> 3] |= 0x01 << ( l_index & 0x07 );
+      }
+      blit_glyph( l_x, p_y, l_shifted, l_width, p_mode );
+    }
+    else
+    {
+      l_bitmap = find_glyph( p_font, *l_char, l_unpacked, &l_index, &l_width, &l_advance );
+      if ( l_bitmap != nullptr )
+      {
+        blit_bitmap( l_x, p_y, l_bitmap, l_width, ( p_font.height + 7 ) / 8, p_mode );
+      }
+    }
+    l_x += l_advance;
   }
 
   /* All done. */
@@ -499,4 +1210,25 @@ void pal::SSD1306::draw_text( uint8_t p_x, uint8_t p_y, const char *p_text, bool
 }
 
 
+/*
+ * text_width; returns how wide a text string is in the given font, from the
+ *             left of the first glyph to where the next would go.
+ */
+
+uint16_t pal::SSD1306Canvas::text_width( const char *p_text, const Font &p_font )
+{
+  uint8_t  l_index, l_width, l_advance;
+  uint16_t l_total = 0;
+
+  for ( const char *l_char = p_text; *l_char != '\0'; l_char++ )
+  {
+    if ( find_glyph( p_font, *l_char, nullptr, &l_index, &l_width, &l_advance ) != nullptr )
+    {
+      l_total += l_advance;
+    }
+  }
+  return l_total;
+}
+
+
  /* End of file pal-ssd1306.cpp */
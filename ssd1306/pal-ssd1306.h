@@ -6,13 +6,43 @@
  *
  * This class provides a driver for the SSD1306 OLED display; this is a fairly
  * common I2C monochrome display available in various dimensions - most commonly
- * 128x64 and 128x32.
+ * 128x64 and 128x32. It can also be driven over SPI, or any other transport.
  */
 
 #ifndef   PAL_SSD1306_H
 #define   PAL_SSD1306_H
 
-#include <hardware/i2c.h>
+#include <array>
+#include <atomic>
+
+#include <stdlib.h>
+
+#include "pal-ssd1306-font.h"
+#include "pal-ssd1306-transport.h"
+
+/* The controller has 64 rows of display RAM, so at most 8 pages of 8 rows. */
+#define SSD1306_MAX_PAGES 8
+
+/* Room for a full command sequence (the init sequence is 25 bytes) behind */
+/* a single control byte.                                                  */
+#define SSD1306_CMD_BUFFER_SZ 32
+
+/* Performance counters (see stats()) are only kept if this is 1, as the    */
+/* PAL_SSD1306_STATS CMake option sets it; otherwise they cost nothing.     */
+#ifndef SSD1306_STATS
+#define SSD1306_STATS 0
+#endif
+
+/* A glyph cache slot has room for 96 glyphs (printable ASCII, and a      */
+/* placeholder) of a font up to 8 columns wide and a page tall.           */
+#define SSD1306_CACHE_GLYPHS 96
+#define SSD1306_CACHE_WIDTH  8
+
+#if SSD1306_STATS
+#define SSD1306_STAT( p_statement ) do { p_statement; } while ( 0 )
+#else
+#define SSD1306_STAT( p_statement ) do { } while ( 0 )
+#endif
 
 namespace pal
 {
@@ -21,10 +51,17 @@ namespace pal
     MEMORYMODE = 0x20,
     COLUMNADDR = 0x21,
     PAGEADDR = 0x22,
+    RIGHT_HORIZONTAL_SCROLL = 0x26,
+    LEFT_HORIZONTAL_SCROLL = 0x27,
+    VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL = 0x29,
+    VERTICAL_AND_LEFT_HORIZONTAL_SCROLL = 0x2A,
+    DEACTIVATE_SCROLL = 0x2E,
+    ACTIVATE_SCROLL = 0x2F,
     SETSTARTLINE = 0x40,
     SETCONTRAST = 0x81,
     CHARGEPUMP = 0x8D,
     SEGREMAP = 0xA1,
+    SET_VERTICAL_SCROLL_AREA = 0xA3,
     DISPLAYALLON = 0xA4,
     NORMALDISPLAY = 0xA6,
     INVERTDISPLAY = 0xA7,
@@ -39,42 +76,463 @@ namespace pal
     SETVCOMDETECT = 0xDB
   } ssd1306_cmd_t;
 
-  class SSD1306
+  /* How render decides which parts of the screen buffer to send. */
+  typedef enum
+  {
+    RENDER_DIRTY,
+    RENDER_SHADOW
+  } ssd1306_render_mode_t;
+
+  /* What render does when handing frames to core1 and it's still busy. */
+  typedef enum
+  {
+    FRAME_BLOCK,
+    FRAME_LATEST
+  } ssd1306_frame_policy_t;
+
+  /* How a frame given to render_async fared; a frame dropped by the core1 */
+  /* FRAME_LATEST policy wasn't sent, but nothing went wrong either.        */
+  typedef enum
+  {
+    FRAME_SENT,
+    FRAME_FAILED,
+    FRAME_DROPPED
+  } ssd1306_frame_status_t;
+
+  /* Completion callback for render_async; called from IRQ context, or on */
+  /* core1, once the frame is done with.                                  */
+  typedef void (*ssd1306_frame_cb_t)( ssd1306_frame_status_t p_status, void *p_context );
+
+  /* How drawing combines with what's already in the screen buffer. */
+  typedef enum
+  {
+    DRAW_CLEAR,
+    DRAW_SET,
+    DRAW_XOR
+  } ssd1306_draw_mode_t;
+
+  /* A glyph cache slot (see enable_glyph_cache); the glyphs of one font, */
+  /* shifted down by one row offset, with a bit set in valid for each one */
+  /* that has been filled in. Each column is a pair of bytes: the part in */
+  /* the glyph's first page, and the part that spills into the next. The  */
+  /* slot was last used when the cache's clock read used.                 */
+  typedef struct
+  {
+    const Font *font;
+    uint8_t     shift;
+    uint32_t    used;
+    uint8_t     valid[( SSD1306_CACHE_GLYPHS + 7 ) / 8];
+    uint8_t     columns[SSD1306_CACHE_GLYPHS][SSD1306_CACHE_WIDTH * 2];
+  } ssd1306_glyph_cache_t;
+
+  /* Performance counters, as returned by stats(); all zero if they're not */
+  /* being kept. Render times cover the frame being sent (or, for an async */
+  /* render, handed over) and the per frame figures are for the last one.  */
+  typedef struct
+  {
+    uint32_t frames;
+    uint32_t bytes_sent;
+    uint32_t transactions;
+    uint32_t write_failures;
+    uint32_t render_last_us;
+    uint32_t render_min_us;
+    uint32_t render_max_us;
+    uint32_t render_avg_us;
+    uint32_t pixels_touched;
+    float    dirty_fraction;
+  } ssd1306_stats_t;
+
+  /*
+   * FrameMailbox; a lock-free triple buffer index, for one producer and one
+   *               consumer (typically on different cores). It only uses
+   *               single byte atomic loads and stores, which the Cortex-M0+
+   *               can do without locking. The producer always has a buffer
+   *               to draw into, and the consumer always gets the newest
+   *               complete frame; neither ever waits for the other.
+   */
+
+  class FrameMailbox
   {
   private:
+    std::atomic<uint8_t> latest;
+    std::atomic<uint8_t> reading;
+    uint8_t              drawing;
+    uint8_t              last_taken;
+
+  public:
+    void    reset( void );
+    uint8_t draw_index( void );
+    uint8_t publish( void );
+    bool    acquire( uint8_t *p_index );
+  };
+
+
+  /*
+   * SSD1306Canvas; the screen buffer, and everything which draws into it;
+   *                none of this needs to know how the frame gets to the
+   *                display, so it is shared by every driver.
+   */
+
+  class SSD1306Canvas
+  {
+  protected:
     uint8_t     width;
     uint8_t     height;
     uint8_t     pagesize;
-    uint8_t     address;
-    bool        external_vcc;
-    i2c_inst_t *i2c_instance;
     uint8_t    *screen_buffer;
     uint8_t    *screen_ptr;
     size_t      screen_buffer_sz;
+    bool        owns_buffer;
+    uint8_t     dirty_min[SSD1306_MAX_PAGES];
+    uint8_t     dirty_max[SSD1306_MAX_PAGES];
 
-    bool write_cmd( ssd1306_cmd_t p_cmd, int16_t p_arg1 = -1, int16_t p_arg2 = -1 );
-    bool write_buffer( uint8_t *p_buffer, size_t p_length );
+    ssd1306_glyph_cache_t *glyph_cache;
+    uint8_t                glyph_cache_slots;
+    uint32_t               glyph_cache_clock;
+    bool                   owns_glyph_cache;
+
+    volatile bool  core1_busy;
+    void         (*core1_renderer)( SSD1306Canvas *p_display );
+
+    static bool core1_launched;
+    static void core1_render( uint32_t p_handle );
+
+#if SSD1306_STATS
+    ssd1306_stats_t stats_data;
+    uint64_t        stats_render_total_us;
+    uint32_t        stats_pixels;
+
+    void stats_write( size_t p_length, bool p_result );
+    void stats_frame( uint64_t p_start_us, size_t p_dirty_bytes );
+    void stats_latch_pixels( void );
+#endif
+
+    /* Widens the dirty window on a page to include the given column. */
+    void mark_dirty( uint8_t p_page, uint8_t p_x )
+    {
+      if ( p_x < dirty_min[p_page] )
+      {
+        dirty_min[p_page] = p_x;
+      }
+      if ( p_x > dirty_max[p_page] )
+      {
+        dirty_max[p_page] = p_x;
+      }
+    }
+
+    void set_dirty( void );
+    void wait_for_core1( void );
+
+    uint8_t                page_clip( uint16_t p_page );
+    void                   blit_glyph( uint8_t p_x, uint8_t p_y, const uint8_t *p_shifted, uint8_t p_width, ssd1306_draw_mode_t p_mode );
+    void                   blit_bitmap( uint8_t p_x, uint8_t p_y, const uint8_t *p_bitmap, uint8_t p_width, uint8_t p_pages, ssd1306_draw_mode_t p_mode );
+    ssd1306_glyph_cache_t *glyph_cache_for( const Font &p_font, uint8_t p_shift );
+
+    template<class Display>
+    static void trace_line( Display *p_display, uint8_t p_x1, uint8_t p_y1, uint8_t p_x2, uint8_t p_y2, bool p_set );
+
+    SSD1306Canvas( uint8_t p_width, uint8_t p_height, uint8_t *p_buffer );
+    ~SSD1306Canvas();
 
   public:
-    SSD1306( uint8_t p_width, uint8_t p_height, i2c_inst_t *p_i2c, uint8_t p_address = 0x3C, bool p_ext_vcc = false );
-    ~SSD1306();
+    /* The size of buffer needed for a display; one byte per column per */
+    /* page, plus a leading byte used when sending it to the display.   */
+    static constexpr size_t buffer_size( uint8_t p_width, uint8_t p_height )
+    {
+      return ( p_width * ( ( p_height + 7 ) / 8 ) ) + 1;
+    }
+
+    uint8_t *frame( void );
+    size_t   frame_size( void );
+    void     mark_dirty_region( uint8_t p_x, uint8_t p_y, uint8_t p_width, uint8_t p_height );
 
     void clear( void );
-    void render( void );
-    void set_contrast( uint8_t p_contrast );
-    void set_invert( bool p_invert );
+
+    bool enable_glyph_cache( uint8_t p_slots = 1, ssd1306_glyph_cache_t *p_cache = nullptr );
+
+    ssd1306_stats_t stats( void );
+    void            reset_stats( void );
+
+    static void core1_worker( void );
+    static bool core1_service( void );
 
     void set_pixel( uint8_t p_x, uint8_t p_y );
     void clear_pixel( uint8_t p_x, uint8_t p_y );
 
     void draw_line( uint8_t p_x1, uint8_t p_y1, uint8_t p_x2, uint8_t p_y2, bool p_set = true );
+    void draw_hline( uint8_t p_x, uint8_t p_y, uint8_t p_width, ssd1306_draw_mode_t p_mode = DRAW_SET );
+    void draw_vline( uint8_t p_x, uint8_t p_y, uint8_t p_height, ssd1306_draw_mode_t p_mode = DRAW_SET );
     void draw_box( uint8_t p_x, uint8_t p_y, uint8_t p_width, uint8_t p_height, bool p_filled, bool p_set = true );
+    void fill_rect( uint8_t p_x, uint8_t p_y, uint8_t p_width, uint8_t p_height, ssd1306_draw_mode_t p_mode = DRAW_SET );
     void draw_char( uint8_t p_x, uint8_t p_y, char p_char, bool p_set = true );
+    void draw_char( uint8_t p_x, uint8_t p_y, char p_char, ssd1306_draw_mode_t p_mode );
+    void draw_char( uint8_t p_x, uint8_t p_y, char p_char, const Font &p_font, ssd1306_draw_mode_t p_mode = DRAW_SET );
     void draw_text( uint8_t p_x, uint8_t p_y, const char *p_text, bool p_set = true );
+    void draw_text( uint8_t p_x, uint8_t p_y, const char *p_text, ssd1306_draw_mode_t p_mode );
+    void draw_text( uint8_t p_x, uint8_t p_y, const char *p_text, const Font &p_font, ssd1306_draw_mode_t p_mode = DRAW_SET );
+
+    static uint16_t text_width( const char *p_text, const Font &p_font );
+  };
+
+
+  /*
+   * SSD1306Driver; drives an SSD1306 over the given transport (see
+   *                pal-ssd1306-transport.h); as this is a template, the
+   *                calls into the transport are direct, not virtual.
+   */
+
+  template<class Transport>
+  class SSD1306Driver : public SSD1306Canvas
+  {
+  protected:
+    Transport   transport;
+
+  private:
+    bool        external_vcc;
+    bool        owns_shadow;
+
+    bool        double_buffered;
+    uint8_t    *front_buffer;
+    uint8_t    *second_buffer;
+    bool        owns_second_buffer;
+    uint8_t     front_min[SSD1306_MAX_PAGES];
+    uint8_t     front_max[SSD1306_MAX_PAGES];
+
+    bool        page_flip;
+    uint8_t     page_offset;
+    uint8_t     flip_min[SSD1306_MAX_PAGES];
+    uint8_t     flip_max[SSD1306_MAX_PAGES];
+
+    bool                    core1_mode;
+    ssd1306_frame_policy_t  frame_policy;
 
+    bool                    mailbox_mode;
+    FrameMailbox            mailbox;
+    uint8_t                *mailbox_buffers[3];
+
+    static void core1_frame( SSD1306Canvas *p_display );
+
+    ssd1306_render_mode_t render_mode;
+    uint8_t              *shadow_buffer;
+    bool                  shadow_valid;
+
+    ssd1306_frame_cb_t    async_cb;
+    void                 *async_cb_context;
+    volatile bool         async_failed;
+
+    static void async_done( bool p_success, void *p_context );
+
+    uint8_t     cmd_buffer[SSD1306_CMD_BUFFER_SZ];
+    uint8_t     cmd_length;
+    bool        cmd_batching;
+
+    bool queue_bytes( const uint8_t *p_bytes, size_t p_length );
+    bool queue_cmd( ssd1306_cmd_t p_cmd, int16_t p_arg1 = -1, int16_t p_arg2 = -1 );
+    bool flush_cmds( bool p_hold = false );
+    bool write_cmd( ssd1306_cmd_t p_cmd, int16_t p_arg1 = -1, int16_t p_arg2 = -1 );
+    void latch_dirty( void );
+    bool front_dirty( void );
+    void clear_dirty( void );
+    void merge_flip_dirty( void );
+    void keep_flip_dirty( void );
+    bool flip_page( void );
+    bool write_window( uint8_t p_page, uint8_t p_first, uint8_t p_last, bool p_set_page );
+    bool render_shadow( void );
+    bool render_frame( void );
+    bool post_frame( ssd1306_frame_cb_t p_callback = nullptr, void *p_context = nullptr );
+    void check_async( void );
+
+  public:
+    SSD1306Driver( uint8_t p_width, uint8_t p_height, const Transport &p_transport, bool p_ext_vcc = false );
+    SSD1306Driver( uint8_t p_width, uint8_t p_height, uint8_t *p_buffer, const Transport &p_transport, bool p_ext_vcc = false );
+    ~SSD1306Driver();
+
+    Transport *get_transport( void ) { return &transport; }
+
+    bool render( void );
+    void invalidate( void );
+    bool set_render_mode( ssd1306_render_mode_t p_mode, uint8_t *p_shadow = nullptr );
+    bool enable_double_buffer( uint8_t *p_buffer = nullptr );
+    void swap( bool p_preserve = true );
+    bool enable_page_flip( void );
+
+    bool enable_mailbox( uint8_t *p_buffers = nullptr );
+    void publish( bool p_preserve = true );
+
+    bool enable_core1( ssd1306_frame_policy_t p_policy = FRAME_LATEST, bool p_launch = true );
+
+    template<typename... Args> bool enable_async( Args... p_args );
+    bool render_async( ssd1306_frame_cb_t p_callback = nullptr, void *p_context = nullptr );
+    bool is_render_busy( void );
+    void begin_commands( void );
+    bool commit( bool p_with_render = false );
+    template<typename... Args> bool queue( ssd1306_cmd_t p_cmd, Args... p_args );
+
+    void set_contrast( uint8_t p_contrast );
+    void set_invert( bool p_invert );
+  };
+
+
+  /*
+   * SSD1306; the original I2C driver, over a transport which can also send
+   *          frames by DMA once enable_async() is called.
+   */
+
+  class SSD1306 : public SSD1306Driver<I2CDMATransport>
+  {
+  public:
+    SSD1306( uint8_t p_width, uint8_t p_height, i2c_inst_t *p_i2c, uint8_t p_address = 0x3C, bool p_ext_vcc = false );
+    SSD1306( uint8_t p_width, uint8_t p_height, uint8_t *p_buffer, i2c_inst_t *p_i2c, uint8_t p_address = 0x3C, bool p_ext_vcc = false );
+  };
+
+
+  /*
+   * SSD1306Storage; holds a statically sized screen buffer. This is a base of
+   *                 SSD1306T, ahead of the driver, so that the buffer exists
+   *                 by the time the driver is constructed over it.
+   */
+
+  template<size_t Size>
+  class SSD1306Storage
+  {
+  protected:
+    std::array<uint8_t, Size> frame_storage;
+  };
+
+
+  /*
+   * SSD1306T; a display of fixed, compile-time dimensions. The screen buffer
+   *           lives inside the object (so no heap is used for it) and the
+   *           pixel primitives, and the diagonal lines drawn with them,
+   *           reduce to constant shifts and masks. Everything else already
+   *           works a byte at a time, where the width only comes into it
+   *           once per page, so is shared with the runtime sized classes.
+   *           These hide the SSD1306Canvas versions, rather than override
+   *           them, so through a pointer or reference to a base class the
+   *           runtime versions are used. It runs over I2C unless given
+   *           another transport.
+   */
+
+  template<uint8_t W, uint8_t H, class Transport = I2CDMATransport>
+  class SSD1306T : private SSD1306Storage<SSD1306Canvas::buffer_size( W, H )>, public SSD1306Driver<Transport>
+  {
+    static_assert( W > 0 && W <= 128, "SSD1306 displays are at most 128 columns wide" );
+    static_assert( H >= 8 && H <= 64 && ( H % 8 ) == 0, "SSD1306 displays have 8 to 64 rows, in whole pages" );
+
+  public:
+    SSD1306T( const Transport &p_transport, bool p_ext_vcc = false )
+      : SSD1306Driver<Transport>( W, H, this->frame_storage.data(), p_transport, p_ext_vcc )
+    {
+    }
+
+    SSD1306T( i2c_inst_t *p_i2c, uint8_t p_address = 0x3C, bool p_ext_vcc = false )
+      : SSD1306T( Transport( p_i2c, p_address ), p_ext_vcc )
+    {
+    }
+
+    void set_pixel( uint8_t p_x, uint8_t p_y )
+    {
+      if ( p_x >= W || p_y >= H )
+      {
+        return;
+      }
+      this->screen_ptr[( ( p_y >> 3 ) * W ) + p_x] |= 0x01 << ( p_y & 0x07 );
+      this->mark_dirty( p_y >> 3, p_x );
+      SSD1306_STAT( this->stats_pixels++ );
+    }
+
+    void clear_pixel( uint8_t p_x, uint8_t p_y )
+    {
+      if ( p_x >= W || p_y >= H )
+      {
+        return;
+      }
+      this->screen_ptr[( ( p_y >> 3 ) * W ) + p_x] &= ~( 0x01 << ( p_y & 0x07 ) );
+      this->mark_dirty( p_y >> 3, p_x );
+      SSD1306_STAT( this->stats_pixels++ );
+    }
+
+    void draw_line( uint8_t p_x1, uint8_t p_y1, uint8_t p_x2, uint8_t p_y2, bool p_set = true )
+    {
+      if ( p_x1 == p_x2 || p_y1 == p_y2 )
+      {
+        SSD1306Canvas::draw_line( p_x1, p_y1, p_x2, p_y2, p_set );
+        return;
+      }
+      SSD1306Canvas::trace_line( this, p_x1, p_y1, p_x2, p_y2, p_set );
+    }
   };
 }
 
+
+/*
+ * trace_line; internal function which draws a line between two points (both
+ *             included) a pixel at a time, with the given display's own
+ *             set_pixel and clear_pixel; so the fixed size displays get to
+ *             use theirs.
+ */
+
+template<class Display>
+void pal::SSD1306Canvas::trace_line( Display *p_display, uint8_t p_x1, uint8_t p_y1,
+                                     uint8_t p_x2, uint8_t p_y2, bool p_set )
+{
+  int16_t l_dx, l_dy, l_sx, l_sy;
+  int16_t l_err, l_e2;
+  uint8_t l_x, l_y;
+
+  /* Work out the deltas and slopes. */
+  l_dx = abs( p_x2 - p_x1 );
+  l_dy = abs( p_y2 - p_y1 ) * -1;
+
+  l_sx = ( p_x1 < p_x2 ) ? 1 : -1;
+  l_sy = ( p_y1 < p_y2 ) ? 1 : -1;
+
+  /* Set the initial error, and the initial pixel. */
+  l_err = l_dx + l_dy;
+  l_x = p_x1;
+  l_y = p_y1;
+
+  /* Now loop until we hit the final pixel. */
+  while( true )
+  {
+    /* Draw the current pixel. */
+    if ( p_set )
+    {
+      p_display->set_pixel( l_x, l_y );
+    }
+    else
+    {
+      p_display->clear_pixel( l_x, l_y );
+    }
+
+    /* End if that was the end of the line. */
+    if ( l_x == p_x2 && l_y == p_y2 )
+    {
+      break;
+    }
+
+    /* Work out the next step. */
+    l_e2 = l_err * 2;
+
+    if ( l_e2 >= l_dy )
+    {
+      l_err += l_dy;
+      l_x += l_sx;
+    }
+
+    if ( l_e2 <= l_dx )
+    {
+      l_err += l_dx;
+      l_y += l_sy;
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+#include "pal-ssd1306-driver.h"
+
 #endif /* PAL_SSD1306_H */
 
 /* End of file pal-ssd1306.h */
@@ -0,0 +1,214 @@
+/*
+ * pal-ssd1306-test-async.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Tests asynchronous rendering over I2CDMATransport, against the host mock
+ * of the DMA channels and I2C interrupts. What matters is the order things
+ * happen in: the I2C interrupt completes the transfer, that clears the busy
+ * flag (and calls the callback), and only then does the next command write
+ * get the bus. The same goes for frames taken from a mailbox.
+ */
+
+/* Header files. */
+
+#include <atomic>
+#include <thread>
+
+#include <hardware/irq.h>
+#include <pico-host.h>
+
+#include "pal-ssd1306.h"
+#include "pal-ssd1306-test.h"
+
+
+/* Constants. */
+
+#define TEST_WIDTH       128
+#define TEST_HEIGHT      32
+#define TEST_DMA_CHANNEL 3
+
+
+/* Globals. */
+
+static pal::SSD1306        *test_display;
+static std::atomic<int>     test_clock;
+static std::atomic<int>     test_writes;
+static std::atomic<int>     test_write_at;
+static std::atomic<bool>    test_write_while_busy;
+static std::atomic<int>     test_callbacks;
+static std::atomic<int>     test_callback_at;
+static std::atomic<int>     test_callback_status;
+static std::atomic<int>     test_complete_at;
+
+
+/* Functions. */
+
+/*
+ * test_writer; takes the blocking I2C writes, noting when each happened and
+ *              whether an asynchronous render was still in flight.
+ */
+
+static int test_writer( i2c_inst_t *p_i2c, uint8_t p_address, const uint8_t *p_src, size_t p_length, bool p_nostop )
+{
+  test_writes++;
+  test_write_at = ++test_clock;
+  if ( test_display != nullptr && test_display->is_render_busy() )
+  {
+    test_write_while_busy = true;
+  }
+  return p_length;
+}
+
+
+/*
+ * test_callback; the render completion callback.
+ */
+
+static void test_callback( pal::ssd1306_frame_status_t p_status, void *p_context )
+{
+  test_callbacks++;
+  test_callback_at = ++test_clock;
+  test_callback_status = p_status;
+  return;
+}
+
+
+/*
+ * test_complete_later; finishes the DMA transfer after a while, from another
+ *                      thread, standing in for the bus taking its time.
+ */
+
+static void test_complete_later( void )
+{
+  sleep_ms( 50 );
+  test_complete_at = ++test_clock;
+  host_dma_complete( TEST_DMA_CHANNEL );
+  return;
+}
+
+
+/*
+ * test_irq_hog; an exclusive handler, belonging to some other code.
+ */
+
+static void test_irq_hog( void )
+{
+  return;
+}
+
+
+/*
+ * main; runs the tests.
+ */
+
+int main( void )
+{
+  const host_dma_transfer_t *l_transfer;
+  const uint16_t            *l_stream;
+  std::thread                l_completer;
+  int                        l_writes, l_callbacks;
+  bool                       l_match;
+
+  host_i2c_set_writer( test_writer );
+  host_dma_mock( true );
+
+  pal::SSD1306 l_display( TEST_WIDTH, TEST_HEIGHT, i2c0 );
+  test_display = &l_display;
+  TEST_CHECK( test_writes == 1 );
+  TEST_CHECK( l_display.enable_async( TEST_DMA_CHANNEL ) );
+
+  /* Start a frame going; it's in flight until the mock says otherwise. */
+  l_display.draw_box( 10, 4, 40, 20, true );
+  l_writes = test_writes;
+  TEST_CHECK( l_display.render_async( test_callback, nullptr ) );
+  TEST_CHECK( test_writes == l_writes + 1 );
+  TEST_CHECK( l_display.is_render_busy() );
+  TEST_CHECK( test_callbacks == 0 );
+
+  /* The DMA stream is the data control byte, then the frame, with a STOP */
+  /* on the last byte.                                                     */
+  l_transfer = host_dma_transfer( TEST_DMA_CHANNEL );
+  TEST_CHECK( l_transfer->busy );
+  TEST_CHECK( l_transfer->size == DMA_SIZE_16 );
+  TEST_CHECK( l_transfer->write == &i2c_get_hw( i2c0 )->data_cmd );
+  TEST_CHECK( l_transfer->count == l_display.frame_size() + 1 );
+  l_stream = (const uint16_t *)l_transfer->read;
+  TEST_CHECK( l_stream[0] == 0x40 );
+  TEST_CHECK( l_stream[l_transfer->count - 1] & I2C_IC_DATA_CMD_STOP_BITS );
+  l_match = true;
+  for ( size_t l_index = 0; l_index < l_display.frame_size(); l_index++ )
+  {
+    if ( ( l_stream[l_index + 1] & 0xFF ) != l_display.frame()[l_index] )
+    {
+      l_match = false;
+    }
+  }
+  TEST_CHECK( l_match );
+
+  /* A command now has to wait for the interrupt; the write must come after */
+  /* the completion, and the callback, and never while the bus is busy.     */
+  l_completer = std::thread( test_complete_later );
+  l_display.set_contrast( 0x7F );
+  l_completer.join();
+  TEST_CHECK( test_writes == l_writes + 2 );
+  TEST_CHECK( test_callbacks == 1 );
+  TEST_CHECK( test_callback_status == pal::FRAME_SENT );
+  TEST_CHECK( test_complete_at < test_callback_at );
+  TEST_CHECK( test_callback_at < test_write_at );
+  TEST_CHECK( !test_write_while_busy );
+  TEST_CHECK( !l_display.is_render_busy() );
+
+  /* An aborted transfer (a missing ACK, say) frees the bus, and says so. */
+  l_writes = test_writes;
+  TEST_CHECK( l_display.render_async( test_callback, nullptr ) );
+  TEST_CHECK( l_display.is_render_busy() );
+  host_i2c_abort( i2c0 );
+  TEST_CHECK( !l_display.is_render_busy() );
+  TEST_CHECK( !host_dma_transfer( TEST_DMA_CHANNEL )->busy );
+  TEST_CHECK( test_callbacks == 2 );
+  TEST_CHECK( test_callback_status == pal::FRAME_FAILED );
+  l_display.set_invert( true );
+  TEST_CHECK( test_writes == l_writes + 2 );
+  TEST_CHECK( !test_write_while_busy );
+
+  /* A mailbox frame goes the same way; the callback waits for the frame. */
+  /* With nothing new published, there's nothing to wait for.             */
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( l_display.enable_mailbox() );
+  l_display.fill_rect( 0, 0, 8, 8 );
+  l_display.publish();
+  l_callbacks = test_callbacks;
+  TEST_CHECK( l_display.render_async( test_callback, nullptr ) );
+  TEST_CHECK( l_display.is_render_busy() );
+  TEST_CHECK( test_callbacks == l_callbacks );
+  host_dma_complete( TEST_DMA_CHANNEL );
+  TEST_CHECK( !l_display.is_render_busy() );
+  TEST_CHECK( test_callbacks == l_callbacks + 1 );
+  TEST_CHECK( test_callback_status == pal::FRAME_SENT );
+  TEST_CHECK( l_display.render_async( test_callback, nullptr ) );
+  TEST_CHECK( !l_display.is_render_busy() );
+  TEST_CHECK( test_callbacks == l_callbacks + 2 );
+  TEST_CHECK( test_callback_status == pal::FRAME_SENT );
+
+  /* If something else has the other bus's interrupt to itself, we can't */
+  /* use it; rendering still works, but blocks.                          */
+  irq_set_exclusive_handler( I2C1_IRQ, test_irq_hog );
+  pal::SSD1306 l_other( TEST_WIDTH, TEST_HEIGHT, i2c1 );
+  test_display = &l_other;
+  TEST_CHECK( !l_other.enable_async() );
+  TEST_CHECK( irq_get_exclusive_handler( I2C1_IRQ ) == test_irq_hog );
+  l_writes = test_writes;
+  l_callbacks = test_callbacks;
+  TEST_CHECK( l_other.render_async( test_callback, nullptr ) );
+  TEST_CHECK( !l_other.is_render_busy() );
+  TEST_CHECK( test_callbacks == l_callbacks + 1 );
+  TEST_CHECK( test_writes > l_writes );
+
+  test_display = nullptr;
+  return test_result( "pal-ssd1306-test-async" );
+}
+
+
+/* End of file pal-ssd1306-test-async.cpp */
@@ -0,0 +1,169 @@
+/*
+ * pal-ssd1306-test-commands.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Tests command batching, over a mock transport; a batch goes out as one
+ * write, and one held for a render is sent by it even if there's nothing
+ * else to send.
+ */
+
+/* Header files. */
+
+#include <string.h>
+
+#include "pal-ssd1306.h"
+#include "pal-ssd1306-test.h"
+
+
+/* Constants. */
+
+#define TEST_WIDTH  128
+#define TEST_HEIGHT 32
+
+
+/* Types. */
+
+typedef pal::SSD1306Driver<pal::MockTransport> test_display_t;
+
+
+/* Functions. */
+
+/*
+ * test_sent; returns true if a command write in the mock's log starts with
+ *            the given bytes.
+ */
+
+static bool test_sent( pal::MockTransport *p_mock, const uint8_t *p_bytes, size_t p_length )
+{
+  const pal::ssd1306_transaction_t *l_entry;
+
+  for ( size_t l_index = 0; l_index < p_mock->count(); l_index++ )
+  {
+    l_entry = p_mock->transaction( l_index );
+    if ( l_entry->command && l_entry->data != nullptr && l_entry->length >= p_length &&
+         memcmp( l_entry->data, p_bytes, p_length ) == 0 )
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/*
+ * test_held; commands held by commit go out with the next render, whatever
+ *            that render finds to send.
+ */
+
+static void test_held( void )
+{
+  const uint8_t       l_contrast[] = { pal::SETCONTRAST, 0x12 };
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+
+  /* With something to draw, they lead the first window. */
+  TEST_CHECK( l_display.render() );
+  l_display.fill_rect( 0, 0, 8, 8 );
+  l_display.begin_commands();
+  l_display.set_contrast( 0x12 );
+  TEST_CHECK( l_display.commit( true ) );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( l_mock->count() == 2 );
+  TEST_CHECK( test_sent( l_mock, l_contrast, sizeof( l_contrast ) ) );
+
+  /* With nothing dirty at all. */
+  l_display.begin_commands();
+  l_display.set_contrast( 0x12 );
+  TEST_CHECK( l_display.commit( true ) );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( l_mock->count() == 1 );
+  TEST_CHECK( test_sent( l_mock, l_contrast, sizeof( l_contrast ) ) );
+
+  /* With a shadow frame, and nothing different from it. */
+  TEST_CHECK( l_display.set_render_mode( pal::RENDER_SHADOW ) );
+  TEST_CHECK( l_display.render() );
+  l_display.fill_rect( 0, 0, 8, 8 );
+  l_display.begin_commands();
+  l_display.set_contrast( 0x12 );
+  TEST_CHECK( l_display.commit( true ) );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( l_mock->count() == 1 );
+  TEST_CHECK( test_sent( l_mock, l_contrast, sizeof( l_contrast ) ) );
+  return;
+}
+
+
+/*
+ * test_held_mailbox; likewise with a mailbox, and no new frame published.
+ */
+
+static void test_held_mailbox( void )
+{
+  const uint8_t       l_invert[] = { pal::INVERTDISPLAY };
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+
+  TEST_CHECK( l_display.enable_mailbox() );
+  TEST_CHECK( l_display.render() );
+  l_display.begin_commands();
+  l_display.set_invert( true );
+  TEST_CHECK( l_display.commit( true ) );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( l_mock->count() == 1 );
+  TEST_CHECK( test_sent( l_mock, l_invert, sizeof( l_invert ) ) );
+  return;
+}
+
+
+/*
+ * test_oversized; a batch that won't fit in one write is refused, rather
+ *                 than being split.
+ */
+
+static void test_oversized( void )
+{
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+  int                 l_queued = 0;
+
+  l_display.begin_commands();
+  for ( int l_index = 0; l_index < 20; l_index++ )
+  {
+    if ( l_display.queue( pal::SETCONTRAST, l_index ) )
+    {
+      l_queued++;
+    }
+  }
+  TEST_CHECK( l_queued == ( SSD1306_CMD_BUFFER_SZ - 1 ) / 2 );
+  TEST_CHECK( !l_display.queue( pal::COLUMNADDR, 0, 127 ) );
+  TEST_CHECK( l_display.queue( pal::NORMALDISPLAY ) );
+  TEST_CHECK( !l_display.queue( pal::NORMALDISPLAY ) );
+
+  l_mock->reset();
+  TEST_CHECK( l_display.commit() );
+  TEST_CHECK( l_mock->count() == 1 );
+  TEST_CHECK( l_mock->transaction( 0 )->length == SSD1306_CMD_BUFFER_SZ - 1 );
+  return;
+}
+
+
+/*
+ * main; runs the tests.
+ */
+
+int main( void )
+{
+  test_held();
+  test_held_mailbox();
+  test_oversized();
+  return test_result( "pal-ssd1306-test-commands" );
+}
+
+
+/* End of file pal-ssd1306-test-commands.cpp */
@@ -0,0 +1,166 @@
+/*
+ * pal-ssd1306-test-draw.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Tests the drawing primitives, over a mock transport; that lines reach as
+ * far as they should, that a fixed size display draws exactly what a
+ * runtime sized one does, and that the glyph cache keeps the rows in use.
+ */
+
+/* Header files. */
+
+#include <string.h>
+
+#include "pal-ssd1306.h"
+#include "fonts/pal-ssd1306-font-5x7.h"
+#include "pal-ssd1306-test.h"
+
+
+/* Constants. */
+
+#define TEST_WIDTH  128
+#define TEST_HEIGHT 64
+
+
+/* Types. */
+
+typedef pal::SSD1306Driver<pal::MockTransport>                       test_display_t;
+typedef pal::SSD1306T<TEST_WIDTH, TEST_HEIGHT, pal::MockTransport> test_fixed_t;
+
+
+/* Functions. */
+
+/*
+ * test_long_lines; a line right across the coordinate range still gets
+ *                  drawn, as far as the edge of the screen.
+ */
+
+static void test_long_lines( void )
+{
+  test_display_t l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  const uint8_t *l_frame = l_display.frame();
+  bool           l_drawn = true;
+
+  l_display.clear();
+  l_display.draw_line( 0, 8, 255, 8 );
+  l_display.draw_line( 255, 16, 0, 16 );
+  l_display.draw_line( 4, 0, 4, 255 );
+  for ( uint8_t l_x = 0; l_x < TEST_WIDTH; l_x++ )
+  {
+    if ( l_x != 4 && l_frame[( TEST_WIDTH * 1 ) + l_x] != 0x01 )
+    {
+      l_drawn = false;
+    }
+    if ( l_x != 4 && l_frame[( TEST_WIDTH * 2 ) + l_x] != 0x01 )
+    {
+      l_drawn = false;
+    }
+  }
+  for ( uint8_t l_page = 0; l_page < TEST_HEIGHT / 8; l_page++ )
+  {
+    if ( l_frame[( TEST_WIDTH * l_page ) + 4] != 0xFF )
+    {
+      l_drawn = false;
+    }
+  }
+  TEST_CHECK( l_drawn );
+
+  /* Lines that start off the screen draw nothing at all. */
+  l_display.clear();
+  l_display.draw_line( 200, 8, 255, 8 );
+  l_display.draw_line( 4, 100, 4, 255 );
+  l_drawn = false;
+  for ( size_t l_index = 0; l_index < l_display.frame_size(); l_index++ )
+  {
+    if ( l_frame[l_index] != 0 )
+    {
+      l_drawn = true;
+    }
+  }
+  TEST_CHECK( !l_drawn );
+  return;
+}
+
+
+/*
+ * test_fixed_lines; lines in every direction come out the same on both.
+ */
+
+static void test_fixed_lines( void )
+{
+  const uint8_t  l_lines[][4] = { {   0,  0, 127, 63 }, { 127,  0,   0, 63 },
+                                  {   5, 60, 100,  2 }, {  10, 10,  11, 50 },
+                                  {   3,  3,   3, 40 }, {   0, 10, 127, 10 },
+                                  {  90, 50,  20, 50 }, {  64, 32,  64, 32 } };
+  test_display_t l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  test_fixed_t   l_fixed{ pal::MockTransport() };
+
+  l_display.clear();
+  l_fixed.clear();
+  for ( const uint8_t *l_line : l_lines )
+  {
+    l_display.draw_line( l_line[0], l_line[1], l_line[2], l_line[3] );
+    l_fixed.draw_line( l_line[0], l_line[1], l_line[2], l_line[3] );
+  }
+  TEST_CHECK( memcmp( l_display.frame(), l_fixed.frame(), l_display.frame_size() ) == 0 );
+
+  /* And the same rubbing them out again. */
+  l_display.draw_line( 0, 0, 127, 63, false );
+  l_fixed.draw_line( 0, 0, 127, 63, false );
+  TEST_CHECK( memcmp( l_display.frame(), l_fixed.frame(), l_display.frame_size() ) == 0 );
+  return;
+}
+
+
+/*
+ * test_glyph_cache; a full glyph cache gives up the slot used least
+ *                   recently, however the slots were filled.
+ */
+
+static void test_glyph_cache( void )
+{
+  test_display_t             l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::ssd1306_glyph_cache_t l_cache[3];
+  bool                       l_kept[4] = { false, false, false, false };
+
+  l_display.clear();
+  TEST_CHECK( l_display.enable_glyph_cache( 3, l_cache ) );
+
+  /* Fill the slots with rows 1 to 3, then use 2 and 1 again. */
+  l_display.draw_text( 0, 1, "A", pal::font_5x7 );
+  l_display.draw_text( 0, 2, "A", pal::font_5x7 );
+  l_display.draw_text( 0, 3, "A", pal::font_5x7 );
+  l_display.draw_text( 0, 2, "A", pal::font_5x7 );
+  l_display.draw_text( 0, 1, "A", pal::font_5x7 );
+
+  /* So row 4 should take row 3's slot. */
+  l_display.draw_text( 0, 4, "A", pal::font_5x7 );
+  for ( const pal::ssd1306_glyph_cache_t &l_slot : l_cache )
+  {
+    TEST_CHECK( l_slot.font == &pal::font_5x7 );
+    if ( l_slot.shift >= 1 && l_slot.shift <= 4 )
+    {
+      l_kept[l_slot.shift - 1] = true;
+    }
+  }
+  TEST_CHECK( l_kept[0] && l_kept[1] && !l_kept[2] && l_kept[3] );
+  return;
+}
+
+
+/*
+ * main; runs the tests.
+ */
+
+int main( void )
+{
+  test_long_lines();
+  test_fixed_lines();
+  test_glyph_cache();
+  return test_result( "pal-ssd1306-test-draw" );
+}
+
+
+/* End of file pal-ssd1306-test-draw.cpp */
@@ -0,0 +1,221 @@
+/*
+ * pal-ssd1306-test-linux.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Tests LinuxI2CTransport against a fake device. A plain file or socket
+ * won't do as one, since ioctl( I2C_RDWR ) on it fails with ENOTTY; so this
+ * test provides its own ioctl, which acts as an I2C adapter for one end of
+ * a socketpair and passes everything else to the kernel. Each message of a
+ * transfer comes out of the other end as a packet, and each transfer is
+ * counted, so the test can see how the writes were combined.
+ */
+
+/* Header files. */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "pal-ssd1306-linux.h"
+#include "pal-ssd1306-test.h"
+
+
+/* Constants. */
+
+#define TEST_WIDTH   128
+#define TEST_HEIGHT  32
+#define TEST_ADDRESS 0x3D
+#define TEST_PACKET  1100
+
+
+/* Globals. */
+
+static int  test_device_fd = -1;
+static int  test_wire_fd = -1;
+static int  test_transfers;
+static bool test_wrong_address;
+
+
+/* Functions. */
+
+/*
+ * ioctl; stands in for the C library's, making the device end of the pair
+ *        an I2C adapter. Anything else goes to the kernel.
+ */
+
+extern "C" int ioctl( int p_fd, unsigned long p_request, ... ) __THROW
+{
+  struct i2c_rdwr_ioctl_data *l_request;
+  va_list                     l_args;
+  void                       *l_arg;
+
+  va_start( l_args, p_request );
+  l_arg = va_arg( l_args, void * );
+  va_end( l_args );
+
+  if ( p_fd != test_device_fd || p_request != I2C_RDWR )
+  {
+    return syscall( SYS_ioctl, p_fd, p_request, l_arg );
+  }
+
+  /* Put each message on the wire, as a packet of its own. */
+  l_request = (struct i2c_rdwr_ioctl_data *)l_arg;
+  test_transfers++;
+  for ( __u32 l_index = 0; l_index < l_request->nmsgs; l_index++ )
+  {
+    if ( l_request->msgs[l_index].addr != TEST_ADDRESS )
+    {
+      test_wrong_address = true;
+    }
+    if ( send( p_fd, l_request->msgs[l_index].buf, l_request->msgs[l_index].len, 0 ) < 0 )
+    {
+      return -1;
+    }
+  }
+  return l_request->nmsgs;
+}
+
+
+/*
+ * test_receive; takes the next message off the wire, returning its length
+ *               or -1 if there isn't one.
+ */
+
+static int test_receive( uint8_t *p_buffer )
+{
+  return recv( test_wire_fd, p_buffer, TEST_PACKET, MSG_DONTWAIT );
+}
+
+
+/*
+ * test_transport; the transport on its own; held commands, data and any
+ *                 trailer go out as a single transfer.
+ */
+
+static void test_transport( void )
+{
+  uint8_t                l_cmds[3] = { 0, pal::PAGEADDR, 0 };
+  uint8_t                l_data[5] = { 0, 0x11, 0x22, 0x33, 0x44 };
+  uint8_t                l_trailer[1] = { pal::SETSTARTLINE };
+  uint8_t                l_long[SSD1306_CMD_BUFFER_SZ + 1];
+  uint8_t                l_packet[TEST_PACKET];
+  pal::LinuxI2CTransport l_transport( test_device_fd, TEST_ADDRESS );
+
+  l_transport.begin();
+
+  /* A command write on its own is one transfer. */
+  test_transfers = 0;
+  TEST_CHECK( l_transport.write_commands( l_cmds + 1, 2, false ) );
+  TEST_CHECK( test_transfers == 1 );
+  TEST_CHECK( test_receive( l_packet ) == 3 );
+  TEST_CHECK( l_packet[0] == 0x00 && l_packet[1] == pal::PAGEADDR );
+
+  /* A held one waits for the data, and goes with it. */
+  test_transfers = 0;
+  TEST_CHECK( l_transport.write_commands( l_cmds + 1, 2, true ) );
+  TEST_CHECK( test_transfers == 0 );
+  TEST_CHECK( l_transport.write_data_async( l_data + 1, 4, l_trailer, 1, nullptr, nullptr ) );
+  TEST_CHECK( test_transfers == 1 );
+  TEST_CHECK( test_receive( l_packet ) == 3 );
+  TEST_CHECK( l_packet[0] == 0x00 && l_packet[1] == pal::PAGEADDR );
+  TEST_CHECK( test_receive( l_packet ) == 5 );
+  TEST_CHECK( l_packet[0] == 0x40 && memcmp( l_packet + 1, l_data + 1, 4 ) == 0 );
+  TEST_CHECK( test_receive( l_packet ) == 2 );
+  TEST_CHECK( l_packet[0] == 0x00 && l_packet[1] == pal::SETSTARTLINE );
+  TEST_CHECK( test_receive( l_packet ) < 0 );
+
+  /* A trailer too long to send is refused, not dropped. */
+  memset( l_long, pal::DISPLAYALLON, sizeof( l_long ) );
+  test_transfers = 0;
+  TEST_CHECK( !l_transport.write_data_async( l_data + 1, 4, l_long, sizeof( l_long ), nullptr, nullptr ) );
+  TEST_CHECK( test_transfers == 0 );
+  TEST_CHECK( !test_wrong_address );
+  return;
+}
+
+
+/*
+ * test_frame; a whole frame through the driver is the window and the data,
+ *             in one transfer.
+ */
+
+static void test_frame( void )
+{
+  uint8_t l_packet[TEST_PACKET];
+  int     l_length;
+  size_t  l_data = 0;
+
+  pal::SSD1306Driver<pal::LinuxI2CTransport> l_display( TEST_WIDTH, TEST_HEIGHT,
+                                                        pal::LinuxI2CTransport( test_device_fd, TEST_ADDRESS ) );
+
+  /* Skip past the display being set up. */
+  while ( test_receive( l_packet ) >= 0 )
+  {
+  }
+
+  test_transfers = 0;
+  l_display.fill_rect( 0, 0, TEST_WIDTH, TEST_HEIGHT );
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( test_transfers == 1 );
+  while ( ( l_length = test_receive( l_packet ) ) >= 0 )
+  {
+    if ( l_length > 0 && l_packet[0] == 0x40 )
+    {
+      l_data += l_length - 1;
+    }
+  }
+  TEST_CHECK( l_data == l_display.frame_size() );
+  return;
+}
+
+
+/*
+ * test_not_a_device; a descriptor that isn't an I2C adapter just fails.
+ */
+
+static void test_not_a_device( void )
+{
+  uint8_t                l_cmds[2] = { 0, pal::DISPLAYON };
+  int                    l_fd = open( "/dev/null", O_RDWR );
+  pal::LinuxI2CTransport l_transport( l_fd, TEST_ADDRESS );
+
+  TEST_CHECK( l_fd >= 0 );
+  TEST_CHECK( !l_transport.write_commands( l_cmds + 1, 1, false ) );
+  TEST_CHECK( errno == ENOTTY );
+  close( l_fd );
+  return;
+}
+
+
+/*
+ * main; runs the tests.
+ */
+
+int main( void )
+{
+  int l_pair[2];
+
+  TEST_CHECK( socketpair( AF_UNIX, SOCK_SEQPACKET, 0, l_pair ) == 0 );
+  test_device_fd = l_pair[0];
+  test_wire_fd = l_pair[1];
+
+  test_transport();
+  test_frame();
+  test_not_a_device();
+
+  close( l_pair[0] );
+  close( l_pair[1] );
+  return test_result( "pal-ssd1306-test-linux" );
+}
+
+
+/* End of file pal-ssd1306-test-linux.cpp */
@@ -0,0 +1,159 @@
+/*
+ * pal-ssd1306-test-mailbox.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * A stress test of FrameMailbox, with a producer and consumer thread
+ * standing in for the two cores. The producer fills each frame with its
+ * frame number; the consumer checks that every frame it takes is whole
+ * (all one number, and staying that way while it's read), that the frames
+ * only ever move forwards, and that it sees the last one in the end. Both
+ * yield in the middle of touching a frame, so that even on a single core
+ * the other gets to run while they're at it.
+ */
+
+/* Header files. */
+
+#include <atomic>
+#include <thread>
+
+#include "pal-ssd1306.h"
+#include "pal-ssd1306-test.h"
+
+
+/* Constants. */
+
+#define TEST_FRAMES       200000
+#define TEST_FRAME_WORDS  64
+#define TEST_READS        4
+
+
+/* Globals. */
+
+static pal::FrameMailbox test_mailbox;
+static uint32_t          test_buffers[3][TEST_FRAME_WORDS];
+static std::atomic<bool> test_done;
+
+
+/* Functions. */
+
+/*
+ * test_fill; fills a buffer with a frame number, optionally yielding half
+ *            way through.
+ */
+
+static void test_fill( uint8_t p_index, uint32_t p_frame, bool p_yield )
+{
+  for ( uint16_t l_word = 0; l_word < TEST_FRAME_WORDS; l_word++ )
+  {
+    if ( p_yield && l_word == TEST_FRAME_WORDS / 2 )
+    {
+      std::this_thread::yield();
+    }
+    test_buffers[p_index][l_word] = p_frame;
+  }
+  return;
+}
+
+
+/*
+ * test_producer; draws and publishes every frame, as fast as it can.
+ */
+
+static void test_producer( void )
+{
+  uint8_t l_index = test_mailbox.draw_index();
+
+  for ( uint32_t l_frame = 1; l_frame <= TEST_FRAMES; l_frame++ )
+  {
+    test_fill( l_index, l_frame, true );
+    l_index = test_mailbox.publish();
+  }
+  test_done = true;
+  return;
+}
+
+
+/*
+ * test_consumer; takes frames until it has the last one, checking each.
+ */
+
+static void test_consumer( uint32_t *p_taken, bool *p_whole, bool *p_forwards )
+{
+  uint32_t l_last = 0, l_frame;
+  uint8_t  l_index;
+  bool     l_first = true, l_finished = false;
+
+  *p_taken = 0;
+  *p_whole = true;
+  *p_forwards = true;
+  while ( !l_finished )
+  {
+    /* Once the producer is done, the next frame taken must be the last. */
+    l_finished = test_done;
+    if ( !test_mailbox.acquire( &l_index ) )
+    {
+      if ( l_finished )
+      {
+        break;
+      }
+      continue;
+    }
+    ( *p_taken )++;
+
+    /* Read it a few times over; the producer mustn't touch it meanwhile. */
+    l_frame = test_buffers[l_index][0];
+    for ( uint8_t l_read = 0; l_read < TEST_READS; l_read++ )
+    {
+      std::this_thread::yield();
+      for ( uint16_t l_word = 0; l_word < TEST_FRAME_WORDS; l_word++ )
+      {
+        if ( test_buffers[l_index][l_word] != l_frame )
+        {
+          *p_whole = false;
+        }
+      }
+    }
+
+    if ( !l_first && l_frame <= l_last )
+    {
+      *p_forwards = false;
+    }
+    l_last = l_frame;
+    l_first = false;
+  }
+
+  /* The newest frame is always there to be taken. */
+  TEST_CHECK( l_last == TEST_FRAMES );
+  return;
+}
+
+
+/*
+ * main; runs the tests.
+ */
+
+int main( void )
+{
+  std::thread l_producer, l_consumer;
+  uint32_t    l_taken;
+  bool        l_whole, l_forwards;
+
+  test_mailbox.reset();
+  test_fill( 0, 0, false );
+
+  l_consumer = std::thread( test_consumer, &l_taken, &l_whole, &l_forwards );
+  l_producer = std::thread( test_producer );
+  l_producer.join();
+  l_consumer.join();
+
+  TEST_CHECK( l_taken > 0 );
+  TEST_CHECK( l_whole );
+  TEST_CHECK( l_forwards );
+  printf( "pal-ssd1306-test-mailbox: %lu of %d frames taken\n", (unsigned long)l_taken, TEST_FRAMES );
+  return test_result( "pal-ssd1306-test-mailbox" );
+}
+
+
+/* End of file pal-ssd1306-test-mailbox.cpp */
@@ -0,0 +1,299 @@
+/*
+ * pal-ssd1306-test-render.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Tests what render sends, over a mock transport; in particular, that
+ * whatever fails to reach the display is sent again by the next render,
+ * and that a page flip never shows a half that didn't all arrive.
+ */
+
+/* Header files. */
+
+#include "pal-ssd1306.h"
+#include "pal-ssd1306-test.h"
+
+
+/* Constants. */
+
+#define TEST_WIDTH  128
+#define TEST_HEIGHT 32
+
+
+/* Types. */
+
+typedef pal::SSD1306Driver<pal::MockTransport> test_display_t;
+
+
+/* Functions. */
+
+/*
+ * test_data_sent; returns the number of data bytes in the mock's log.
+ */
+
+static size_t test_data_sent( pal::MockTransport *p_mock )
+{
+  const pal::ssd1306_transaction_t *l_entry;
+  size_t                            l_total = 0;
+
+  for ( size_t l_index = 0; l_index < p_mock->count(); l_index++ )
+  {
+    l_entry = p_mock->transaction( l_index );
+    if ( !l_entry->command )
+    {
+      l_total += l_entry->length;
+    }
+  }
+  return l_total;
+}
+
+
+/*
+ * test_command_arg; returns the first argument of the first logged write of
+ *                   the given command, or -1 if there wasn't one. With a mask,
+ *                   the command's low bits are its argument (as SETSTARTLINE).
+ */
+
+static int test_command_arg( pal::MockTransport *p_mock, uint8_t p_cmd, uint8_t p_mask = 0xFF )
+{
+  const pal::ssd1306_transaction_t *l_entry;
+
+  for ( size_t l_index = 0; l_index < p_mock->count(); l_index++ )
+  {
+    l_entry = p_mock->transaction( l_index );
+    if ( !l_entry->command || l_entry->data == nullptr || ( l_entry->data[0] & p_mask ) != p_cmd )
+    {
+      continue;
+    }
+    if ( p_mask != 0xFF )
+    {
+      return l_entry->data[0] & ~p_mask;
+    }
+    return ( l_entry->length > 1 ) ? l_entry->data[1] : -1;
+  }
+  return -1;
+}
+
+
+/*
+ * test_retry_windows; a window that fails is sent again.
+ */
+
+static void test_retry_windows( void )
+{
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+
+  TEST_CHECK( l_display.render() );
+  l_display.fill_rect( 10, 0, 20, 8 );
+
+  l_mock->set_failing( true );
+  TEST_CHECK( !l_display.render() );
+
+  l_mock->set_failing( false );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( test_data_sent( l_mock ) == 20 );
+
+  /* And once it's there, there's nothing more to send. */
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( l_mock->count() == 0 );
+  return;
+}
+
+
+/*
+ * test_retry_flip; a page flipped render that fails doesn't flip, and the
+ *                  retry goes back into the same hidden half; once that's
+ *                  shown, the other half catches up.
+ */
+
+static void test_retry_flip( void )
+{
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+
+  /* Get both halves up to date; the next frame goes into the lower one. */
+  TEST_CHECK( l_display.enable_page_flip() );
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( l_display.render() );
+
+  l_display.fill_rect( 10, 0, 20, 8 );
+  l_mock->set_failing( true );
+  l_mock->reset();
+  TEST_CHECK( !l_display.render() );
+  TEST_CHECK( test_command_arg( l_mock, pal::PAGEADDR ) == 4 );
+  TEST_CHECK( test_command_arg( l_mock, pal::SETSTARTLINE, 0xC0 ) == -1 );
+
+  l_mock->set_failing( false );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( test_command_arg( l_mock, pal::PAGEADDR ) == 4 );
+  TEST_CHECK( test_command_arg( l_mock, pal::SETSTARTLINE, 0xC0 ) == 32 );
+
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( test_command_arg( l_mock, pal::PAGEADDR ) == 0 );
+  TEST_CHECK( test_data_sent( l_mock ) == 20 );
+  TEST_CHECK( test_command_arg( l_mock, pal::SETSTARTLINE, 0xC0 ) == 0 );
+  return;
+}
+
+
+/*
+ * test_retry_full; a whole frame that fails is sent again.
+ */
+
+static void test_retry_full( void )
+{
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+
+  l_mock->set_failing( true );
+  TEST_CHECK( !l_display.render() );
+
+  l_mock->set_failing( false );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( test_data_sent( l_mock ) == l_display.frame_size() );
+  return;
+}
+
+
+/*
+ * test_retry_mailbox; a mailbox frame that fails is sent again, even with
+ *                     nothing new published.
+ */
+
+static void test_retry_mailbox( void )
+{
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+
+  TEST_CHECK( l_display.enable_mailbox() );
+  TEST_CHECK( l_display.render() );
+  l_display.fill_rect( 0, 0, 8, 8 );
+  l_display.publish();
+
+  l_mock->set_failing( true );
+  TEST_CHECK( !l_display.render() );
+
+  l_mock->set_failing( false );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( test_data_sent( l_mock ) == l_display.frame_size() );
+
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( l_mock->count() == 0 );
+  return;
+}
+
+
+/*
+ * test_retry_shadow; a shadow frame isn't updated with windows that fail.
+ */
+
+static void test_retry_shadow( void )
+{
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+
+  TEST_CHECK( l_display.set_render_mode( pal::RENDER_SHADOW ) );
+  TEST_CHECK( l_display.render() );
+  l_display.fill_rect( 40, 8, 10, 8 );
+
+  l_mock->set_failing( true );
+  TEST_CHECK( !l_display.render() );
+
+  l_mock->set_failing( false );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( test_data_sent( l_mock ) == 10 );
+  return;
+}
+
+
+/*
+ * test_async_callback; notes how an asynchronous render went.
+ */
+
+static void test_async_callback( pal::ssd1306_frame_status_t p_status, void *p_context )
+{
+  *(int *)p_context = ( p_status == pal::FRAME_SENT ) ? 1 : 0;
+  return;
+}
+
+
+/*
+ * test_retry_async; a failed asynchronous render means the next render has
+ *                   to send everything, shadow or not.
+ */
+
+static void test_retry_async( void )
+{
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+  int                 l_status = -1;
+
+  TEST_CHECK( l_display.set_render_mode( pal::RENDER_SHADOW ) );
+  TEST_CHECK( l_display.render() );
+  l_display.fill_rect( 0, 0, 4, 4 );
+
+  l_mock->set_failing( true );
+  TEST_CHECK( !l_display.render_async( test_async_callback, &l_status ) );
+  TEST_CHECK( l_status == 0 );
+
+  l_mock->set_failing( false );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( test_data_sent( l_mock ) == l_display.frame_size() );
+
+  /* Whereas after one that worked, there's nothing left to send. */
+  l_display.fill_rect( 0, 0, 4, 4, pal::DRAW_CLEAR );
+  TEST_CHECK( l_display.render_async( test_async_callback, &l_status ) );
+  TEST_CHECK( l_status == 1 );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( l_mock->count() == 0 );
+  return;
+}
+
+
+/*
+ * test_no_core1; there's no core1 off the Pico, so rendering stays here.
+ */
+
+static void test_no_core1( void )
+{
+  test_display_t      l_display( TEST_WIDTH, TEST_HEIGHT, pal::MockTransport() );
+  pal::MockTransport *l_mock = l_display.get_transport();
+
+  TEST_CHECK( !l_display.enable_core1() );
+  l_mock->reset();
+  TEST_CHECK( l_display.render() );
+  TEST_CHECK( test_data_sent( l_mock ) == l_display.frame_size() );
+  return;
+}
+
+
+/*
+ * main; runs the tests.
+ */
+
+int main( void )
+{
+  test_retry_windows();
+  test_retry_flip();
+  test_retry_full();
+  test_retry_mailbox();
+  test_retry_shadow();
+  test_retry_async();
+  test_no_core1();
+  return test_result( "pal-ssd1306-test-render" );
+}
+
+
+/* End of file pal-ssd1306-test-render.cpp */
@@ -0,0 +1,180 @@
+/*
+ * pal-ssd1306-test-transport.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Tests what the transports put on the bus, against the host stand-ins; in
+ * particular, that a trailer is always sent in full, and that the mock logs
+ * it the way it would really be sent.
+ */
+
+/* Header files. */
+
+#include <string.h>
+
+#include <pico-host.h>
+
+#include "pal-ssd1306.h"
+#include "pal-ssd1306-timing.h"
+#include "pal-ssd1306-test.h"
+
+
+/* Constants. */
+
+#define TEST_WRITES 8
+#define TEST_BYTES  64
+
+
+/* Types. */
+
+/* A blocking I2C write, as it reached the bus. */
+typedef struct
+{
+  uint8_t bytes[TEST_BYTES];
+  size_t  length;
+  bool    nostop;
+} test_write_t;
+
+
+/* Globals. */
+
+static test_write_t test_writes[TEST_WRITES];
+static size_t       test_write_count;
+
+
+/* Functions. */
+
+/*
+ * test_writer; takes the blocking I2C writes, and keeps them.
+ */
+
+static int test_writer( i2c_inst_t *p_i2c, uint8_t p_address, const uint8_t *p_src, size_t p_length, bool p_nostop )
+{
+  if ( test_write_count < TEST_WRITES && p_length <= TEST_BYTES )
+  {
+    memcpy( test_writes[test_write_count].bytes, p_src, p_length );
+    test_writes[test_write_count].length = p_length;
+    test_writes[test_write_count].nostop = p_nostop;
+  }
+  test_write_count++;
+  return p_length;
+}
+
+
+/*
+ * test_callback; notes how the write went.
+ */
+
+static void test_callback( bool p_success, void *p_context )
+{
+  *(int *)p_context = p_success ? 1 : 0;
+  return;
+}
+
+
+/*
+ * test_i2c_trailer; a trailer too long to copy in one go is still sent, all
+ *                   of it, and held together on the bus behind the data.
+ */
+
+static void test_i2c_trailer( void )
+{
+  uint8_t            l_data[5] = { 0, 0xAA, 0xBB, 0xCC, 0xDD };
+  uint8_t            l_trailer[12];
+  uint8_t            l_sent[sizeof( l_trailer )];
+  size_t             l_sent_length = 0;
+  int                l_status = -1;
+  pal::I2CTransport  l_transport( i2c0 );
+
+  for ( size_t l_index = 0; l_index < sizeof( l_trailer ); l_index++ )
+  {
+    l_trailer[l_index] = 0x80 + l_index;
+  }
+
+  test_write_count = 0;
+  TEST_CHECK( l_transport.write_data_async( l_data + 1, 4, l_trailer, sizeof( l_trailer ),
+                                            test_callback, &l_status ) );
+  TEST_CHECK( l_status == 1 );
+  TEST_CHECK( test_write_count >= 2 && test_write_count <= TEST_WRITES );
+  if ( test_write_count < 2 || test_write_count > TEST_WRITES )
+  {
+    return;
+  }
+
+  /* First the data, on its own. */
+  TEST_CHECK( test_writes[0].length == 5 );
+  TEST_CHECK( test_writes[0].bytes[0] == 0x40 );
+  TEST_CHECK( !test_writes[0].nostop );
+
+  /* Then the trailer, as command writes, with only the last one stopping. */
+  for ( size_t l_index = 1; l_index < test_write_count; l_index++ )
+  {
+    TEST_CHECK( test_writes[l_index].bytes[0] == 0x00 );
+    TEST_CHECK( test_writes[l_index].nostop == ( l_index < test_write_count - 1 ) );
+    if ( l_sent_length + test_writes[l_index].length - 1 <= sizeof( l_sent ) )
+    {
+      memcpy( l_sent + l_sent_length, test_writes[l_index].bytes + 1, test_writes[l_index].length - 1 );
+    }
+    l_sent_length += test_writes[l_index].length - 1;
+  }
+  TEST_CHECK( l_sent_length == sizeof( l_trailer ) );
+  TEST_CHECK( memcmp( l_sent, l_trailer, sizeof( l_trailer ) ) == 0 );
+  return;
+}
+
+
+/*
+ * test_mock_trailer; the mock logs an asynchronous write's trailer in the
+ *                    same transaction as its data, after a repeated START,
+ *                    as the DMA transports send it; so that's what the bus
+ *                    timing model is given.
+ */
+
+static void test_mock_trailer( void )
+{
+  uint8_t                           l_data[5] = { 0, 0xAA, 0xBB, 0xCC, 0xDD };
+  uint8_t                           l_trailer[1] = { pal::SETSTARTLINE };
+  pal::MockTransport                l_mock;
+  pal::I2CTimingModel               l_model;
+  const pal::ssd1306_transaction_t *l_entry;
+
+  TEST_CHECK( l_mock.write_data_async( l_data + 1, 4, l_trailer, 1, nullptr, nullptr ) );
+  TEST_CHECK( l_mock.count() == 2 );
+  if ( l_mock.count() != 2 )
+  {
+    return;
+  }
+
+  l_entry = l_mock.transaction( 0 );
+  TEST_CHECK( !l_entry->command && l_entry->hold && l_entry->length == 4 );
+  l_entry = l_mock.transaction( 1 );
+  TEST_CHECK( l_entry->command && !l_entry->hold && l_entry->length == 1 );
+
+  /* One START, a repeated START and one STOP, around the two writes. */
+  TEST_CHECK( l_model.add( &l_mock ) );
+  TEST_CHECK( l_model.timing()->bus_clocks == 1 + ( 9 * ( 4 + 2 ) ) + 1 + ( 9 * ( 1 + 2 ) ) + 1 );
+
+  /* Without a trailer, the data stands alone. */
+  l_mock.reset();
+  TEST_CHECK( l_mock.write_data_async( l_data + 1, 4, nullptr, 0, nullptr, nullptr ) );
+  TEST_CHECK( l_mock.count() == 1 && !l_mock.transaction( 0 )->hold );
+  return;
+}
+
+
+/*
+ * main; runs the tests.
+ */
+
+int main( void )
+{
+  host_i2c_set_writer( test_writer );
+
+  test_i2c_trailer();
+  test_mock_trailer();
+  return test_result( "pal-ssd1306-test-transport" );
+}
+
+
+/* End of file pal-ssd1306-test-transport.cpp */
@@ -0,0 +1,40 @@
+/*
+ * pal-ssd1306-test.h - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * The little there is to the host tests; each is a program which checks
+ * what it expects with TEST_CHECK, and returns test_result() from main, so
+ * that any failed check fails the test under ctest.
+ */
+
+#ifndef   PAL_SSD1306_TEST_H
+#define   PAL_SSD1306_TEST_H
+
+#include <stdio.h>
+
+static int test_checks;
+static int test_failures;
+
+#define TEST_CHECK( p_condition ) \
+  do \
+  { \
+    test_checks++; \
+    if ( !( p_condition ) ) \
+    { \
+      fprintf( stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #p_condition ); \
+      test_failures++; \
+    } \
+  } while ( 0 )
+
+/* Reports how the checks went, and returns main's exit status. */
+static inline int test_result( const char *p_name )
+{
+  printf( "%s: %d checks, %d failed\n", p_name, test_checks, test_failures );
+  return ( test_failures == 0 ) ? 0 : 1;
+}
+
+#endif /* PAL_SSD1306_TEST_H */
+
+/* End of file pal-ssd1306-test.h */
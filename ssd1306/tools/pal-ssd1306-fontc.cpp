@@ -0,0 +1,793 @@
+/*
+ * pal-ssd1306-fontc.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Compiles a BDF or PSF bitmap font into a font header for pal-ssd1306; the
+ * glyphs are laid out as draw_char expects them (see pal-ssd1306-font.h), so
+ * they are drawn straight from flash with no conversion.
+ *
+ *   pal-ssd1306-fontc [options] <font.bdf|font.psf>
+ *     -n NAME       name of the font (default font_<file name>)
+ *     -o FILE       write the header to FILE (default stdout)
+ *     -r FIRST-LAST range of codepoints to include (default 0x20-0x7E)
+ *     -c CHARS      only include these characters
+ *     -f CODE       codepoint drawn for anything not in the font
+ *     -p            make it proportional, trimming the blank columns
+ *     -z            run length pack the glyphs
+ */
+
+/* Header files. */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "pal-ssd1306-font.h"
+
+
+/* Constants. */
+
+#define FONTC_CODEPOINTS  256
+#define FONTC_MAX_HEIGHT  64
+
+
+/* Types. */
+
+/* A glyph as read from the font; a cell of pixels, one byte each. */
+typedef struct
+{
+  bool                  present;
+  int                   width;
+  int                   advance;
+  std::vector<uint8_t>  pixels;
+} fontc_glyph_t;
+
+typedef struct
+{
+  int            height;
+  fontc_glyph_t  glyphs[FONTC_CODEPOINTS];
+} fontc_font_t;
+
+
+/* Functions. */
+
+/*
+ * read_file; reads a whole file into memory.
+ */
+
+static bool read_file( const char *p_filename, std::vector<uint8_t> *p_data )
+{
+  FILE   *l_file;
+  uint8_t l_buffer[4096];
+  size_t  l_read;
+
+  l_file = fopen( p_filename, "rb" );
+  if ( l_file == nullptr )
+  {
+    fprintf( stderr, "Unable to open %s\n", p_filename );
+    return false;
+  }
+  while ( ( l_read = fread( l_buffer, 1, sizeof( l_buffer ), l_file ) ) > 0 )
+  {
+    p_data->insert( p_data->end(), l_buffer, l_buffer + l_read );
+  }
+  fclose( l_file );
+  return true;
+}
+
+
+/*
+ * set_pixel; lights a pixel of a glyph's cell, if it falls inside it.
+ */
+
+static void set_pixel( fontc_font_t *p_font, fontc_glyph_t *p_glyph, int p_x, int p_y )
+{
+  if ( p_x >= 0 && p_x < p_glyph->width && p_y >= 0 && p_y < p_font->height )
+  {
+    p_glyph->pixels[( p_y * p_glyph->width ) + p_x] = 1;
+  }
+  return;
+}
+
+
+/*
+ * parse_bdf; reads a BDF font. Each glyph's cell is as wide as its DWIDTH,
+ *            and as tall as the font's ascent and descent; the glyph's
+ *            bitmap is placed in it by its BBX.
+ */
+
+static bool parse_bdf( const std::vector<uint8_t> &p_data, fontc_font_t *p_font )
+{
+  std::string    l_text( p_data.begin(), p_data.end() );
+  size_t         l_start = 0, l_end;
+  char           l_keyword[32];
+  int            l_box[4] = { 0, 0, 0, 0 }, l_bbx[4] = { 0, 0, 0, 0 };
+  int            l_ascent = -1, l_descent = -1;
+  int            l_encoding = -1, l_dwidth = -1, l_row = -1;
+  fontc_glyph_t *l_glyph;
+
+  /* Work through the file a line at a time. */
+  while ( l_start < l_text.size() )
+  {
+    l_end = l_text.find( '\n', l_start );
+    if ( l_end == std::string::npos )
+    {
+      l_end = l_text.size();
+    }
+    std::string l_line = l_text.substr( l_start, l_end - l_start );
+    l_start = l_end + 1;
+
+    /* Rows of a glyph's bitmap are hex, most significant bit leftmost. */
+    if ( l_row >= 0 && l_line.compare( 0, 7, "ENDCHAR" ) != 0 )
+    {
+      if ( l_encoding >= 0 && l_encoding < FONTC_CODEPOINTS )
+      {
+        l_glyph = &p_font->glyphs[l_encoding];
+        for ( int l_column = 0; l_column < l_bbx[0]; l_column++ )
+        {
+          size_t l_digit = l_column / 4;
+          int    l_value;
+
+          if ( l_digit >= l_line.size() || sscanf( l_line.substr( l_digit, 1 ).c_str(), "%x", &l_value ) != 1 )
+          {
+            break;
+          }
+          if ( l_value & ( 0x08 >> ( l_column % 4 ) ) )
+          {
+            set_pixel( p_font, l_glyph, l_bbx[2] + l_column, l_ascent - ( l_bbx[3] + l_bbx[1] ) + l_row );
+          }
+        }
+      }
+      l_row++;
+      continue;
+    }
+
+    if ( sscanf( l_line.c_str(), "%31s", l_keyword ) != 1 )
+    {
+      continue;
+    }
+    if ( strcmp( l_keyword, "FONTBOUNDINGBOX" ) == 0 )
+    {
+      sscanf( l_line.c_str(), "%*s %d %d %d %d", &l_box[0], &l_box[1], &l_box[2], &l_box[3] );
+    }
+    else if ( strcmp( l_keyword, "FONT_ASCENT" ) == 0 )
+    {
+      sscanf( l_line.c_str(), "%*s %d", &l_ascent );
+    }
+    else if ( strcmp( l_keyword, "FONT_DESCENT" ) == 0 )
+    {
+      sscanf( l_line.c_str(), "%*s %d", &l_descent );
+    }
+    else if ( strcmp( l_keyword, "STARTCHAR" ) == 0 )
+    {
+      l_encoding = l_dwidth = -1;
+      memcpy( l_bbx, l_box, sizeof( l_bbx ) );
+    }
+    else if ( strcmp( l_keyword, "ENCODING" ) == 0 )
+    {
+      sscanf( l_line.c_str(), "%*s %d", &l_encoding );
+    }
+    else if ( strcmp( l_keyword, "DWIDTH" ) == 0 )
+    {
+      sscanf( l_line.c_str(), "%*s %d", &l_dwidth );
+    }
+    else if ( strcmp( l_keyword, "BBX" ) == 0 )
+    {
+      sscanf( l_line.c_str(), "%*s %d %d %d %d", &l_bbx[0], &l_bbx[1], &l_bbx[2], &l_bbx[3] );
+    }
+    else if ( strcmp( l_keyword, "BITMAP" ) == 0 )
+    {
+      /* By now we know the font's height, and this glyph's cell. */
+      if ( l_ascent < 0 || l_descent < 0 )
+      {
+        l_ascent = l_box[1] + l_box[3];
+        l_descent = -l_box[3];
+      }
+      p_font->height = l_ascent + l_descent;
+      if ( p_font->height <= 0 || p_font->height > FONTC_MAX_HEIGHT )
+      {
+        fprintf( stderr, "Font is %d pixels tall; it must be 1 to %d\n", p_font->height, FONTC_MAX_HEIGHT );
+        return false;
+      }
+      if ( l_encoding >= 0 && l_encoding < FONTC_CODEPOINTS )
+      {
+        l_glyph = &p_font->glyphs[l_encoding];
+        l_glyph->present = true;
+        l_glyph->width = l_glyph->advance = ( l_dwidth >= 0 ) ? l_dwidth : l_box[0];
+        l_glyph->pixels.assign( l_glyph->width * p_font->height, 0 );
+      }
+      l_row = 0;
+    }
+    else if ( strcmp( l_keyword, "ENDCHAR" ) == 0 )
+    {
+      l_row = -1;
+    }
+  }
+
+  return p_font->height > 0;
+}
+
+
+/*
+ * read_utf8; decodes a UTF-8 sequence from a PSF unicode table, returning the
+ *            codepoint, or -1 at the end of a glyph's entry.
+ */
+
+static int read_utf8( const std::vector<uint8_t> &p_data, size_t *p_offset )
+{
+  uint8_t l_byte = p_data[( *p_offset )++];
+  int     l_code, l_extra;
+
+  if ( l_byte == 0xFF || l_byte == 0xFE )
+  {
+    return -1;
+  }
+  l_extra = ( l_byte >= 0xF0 ) ? 3 : ( l_byte >= 0xE0 ) ? 2 : ( l_byte >= 0xC0 ) ? 1 : 0;
+  l_code = l_byte & ( ( l_extra == 0 ) ? 0x7F : ( 0x3F >> l_extra ) );
+  while ( l_extra-- > 0 && *p_offset < p_data.size() )
+  {
+    l_code = ( l_code << 6 ) | ( p_data[( *p_offset )++] & 0x3F );
+  }
+  return l_code;
+}
+
+
+/*
+ * parse_psf; reads a PSF (version 1 or 2) console font. If it has a unicode
+ *            table, that says which glyph is which codepoint; otherwise the
+ *            glyphs are taken to be in codepoint order.
+ */
+
+static bool parse_psf( const std::vector<uint8_t> &p_data, fontc_font_t *p_font )
+{
+  uint32_t             l_header, l_count, l_size, l_width, l_height;
+  bool                 l_unicode, l_psf2;
+  size_t               l_offset;
+  std::vector<int>     l_mapping;
+
+  /* Work out which version this is, and what's in it. */
+  l_psf2 = ( p_data.size() >= 32 && p_data[0] == 0x72 && p_data[1] == 0xB5 && p_data[2] == 0x4A && p_data[3] == 0x86 );
+  if ( l_psf2 )
+  {
+    auto l_word = [&]( size_t p_at ) -> uint32_t {
+      return p_data[p_at] | ( p_data[p_at + 1] << 8 ) | ( p_data[p_at + 2] << 16 ) | ( (uint32_t)p_data[p_at + 3] << 24 );
+    };
+    l_header = l_word( 8 );
+    l_unicode = ( l_word( 12 ) & 0x01 ) != 0;
+    l_count = l_word( 16 );
+    l_size = l_word( 20 );
+    l_height = l_word( 24 );
+    l_width = l_word( 28 );
+  }
+  else if ( p_data.size() >= 4 && p_data[0] == 0x36 && p_data[1] == 0x04 )
+  {
+    l_header = 4;
+    l_unicode = ( p_data[2] & 0x06 ) != 0;
+    l_count = ( p_data[2] & 0x01 ) ? 512 : 256;
+    l_size = l_height = p_data[3];
+    l_width = 8;
+  }
+  else
+  {
+    fprintf( stderr, "Not a PSF font\n" );
+    return false;
+  }
+  if ( l_height == 0 || l_height > FONTC_MAX_HEIGHT || l_width == 0 || l_width > 255 ||
+       l_size < ( ( l_width + 7 ) / 8 ) * l_height || l_header + ( (size_t)l_count * l_size ) > p_data.size() )
+  {
+    fprintf( stderr, "PSF font is damaged, or too large (%ux%u)\n", l_width, l_height );
+    return false;
+  }
+  p_font->height = l_height;
+
+  /* Map glyphs to codepoints, from the unicode table if there is one. */
+  l_mapping.assign( FONTC_CODEPOINTS, -1 );
+  l_offset = l_header + ( (size_t)l_count * l_size );
+  for ( uint32_t l_index = 0; l_index < l_count; l_index++ )
+  {
+    if ( !l_unicode )
+    {
+      if ( l_index < FONTC_CODEPOINTS )
+      {
+        l_mapping[l_index] = l_index;
+      }
+      continue;
+    }
+
+    /* Each entry lists the codepoints the glyph stands for, then any */
+    /* sequences it stands for (which we've no use for).              */
+    bool l_sequences = false;
+    while ( l_offset + ( l_psf2 ? 0 : 1 ) < p_data.size() )
+    {
+      int l_code;
+
+      if ( l_psf2 )
+      {
+        if ( p_data[l_offset] == 0xFF )
+        {
+          l_offset++;
+          break;
+        }
+        if ( p_data[l_offset] == 0xFE )
+        {
+          l_sequences = true;
+        }
+        l_code = read_utf8( p_data, &l_offset );
+      }
+      else
+      {
+        l_code = p_data[l_offset] | ( p_data[l_offset + 1] << 8 );
+        l_offset += 2;
+        if ( l_code == 0xFFFF )
+        {
+          break;
+        }
+        if ( l_code == 0xFFFE )
+        {
+          l_sequences = true;
+          l_code = -1;
+        }
+      }
+      if ( !l_sequences && l_code >= 0 && l_code < FONTC_CODEPOINTS && l_mapping[l_code] < 0 )
+      {
+        l_mapping[l_code] = l_index;
+      }
+    }
+  }
+
+  /* And unpack the glyphs; rows of bytes, most significant bit leftmost. */
+  for ( int l_code = 0; l_code < FONTC_CODEPOINTS; l_code++ )
+  {
+    const uint8_t *l_rows;
+    fontc_glyph_t *l_glyph = &p_font->glyphs[l_code];
+
+    if ( l_mapping[l_code] < 0 )
+    {
+      continue;
+    }
+    l_rows = p_data.data() + l_header + ( (size_t)l_mapping[l_code] * l_size );
+    l_glyph->present = true;
+    l_glyph->width = l_glyph->advance = l_width;
+    l_glyph->pixels.assign( l_width * l_height, 0 );
+    for ( uint32_t l_y = 0; l_y < l_height; l_y++ )
+    {
+      for ( uint32_t l_x = 0; l_x < l_width; l_x++ )
+      {
+        if ( l_rows[( l_y * ( ( l_width + 7 ) / 8 ) ) + ( l_x / 8 )] & ( 0x80 >> ( l_x % 8 ) ) )
+        {
+          set_pixel( p_font, l_glyph, l_x, l_y );
+        }
+      }
+    }
+  }
+  return true;
+}
+
+
+/*
+ * trim_glyph; makes a glyph proportional, dropping the blank columns either
+ *             side of it and advancing one column past it. A blank glyph
+ *             (a space) keeps half its width, as an advance.
+ */
+
+static void trim_glyph( fontc_font_t *p_font, fontc_glyph_t *p_glyph )
+{
+  int                  l_left = p_glyph->width, l_right = -1;
+  std::vector<uint8_t> l_pixels;
+
+  for ( int l_y = 0; l_y < p_font->height; l_y++ )
+  {
+    for ( int l_x = 0; l_x < p_glyph->width; l_x++ )
+    {
+      if ( p_glyph->pixels[( l_y * p_glyph->width ) + l_x] )
+      {
+        l_left = ( l_x < l_left ) ? l_x : l_left;
+        l_right = ( l_x > l_right ) ? l_x : l_right;
+      }
+    }
+  }
+
+  if ( l_right < 0 )
+  {
+    p_glyph->advance = ( p_glyph->advance + 1 ) / 2;
+    p_glyph->width = 0;
+    p_glyph->pixels.clear();
+    return;
+  }
+
+  for ( int l_y = 0; l_y < p_font->height; l_y++ )
+  {
+    for ( int l_x = l_left; l_x <= l_right; l_x++ )
+    {
+      l_pixels.push_back( p_glyph->pixels[( l_y * p_glyph->width ) + l_x] );
+    }
+  }
+  p_glyph->width = l_right - l_left + 1;
+  p_glyph->advance = p_glyph->width + 1;
+  p_glyph->pixels = l_pixels;
+  return;
+}
+
+
+/*
+ * glyph_columns; lays a glyph out as draw_char wants it: column by column,
+ *                a byte per page, with the top row of each page in bit 0.
+ */
+
+static std::vector<uint8_t> glyph_columns( const fontc_font_t *p_font, const fontc_glyph_t *p_glyph )
+{
+  std::vector<uint8_t> l_columns;
+  int                  l_pages = ( p_font->height + 7 ) / 8;
+
+  for ( int l_x = 0; l_x < p_glyph->width; l_x++ )
+  {
+    for ( int l_page = 0; l_page < l_pages; l_page++ )
+    {
+      uint8_t l_byte = 0;
+
+      for ( int l_bit = 0; l_bit < 8 && ( l_page * 8 ) + l_bit < p_font->height; l_bit++ )
+      {
+        if ( p_glyph->pixels[( ( ( l_page * 8 ) + l_bit ) * p_glyph->width ) + l_x] )
+        {
+          l_byte |= 0x01 << l_bit;
+        }
+      }
+      l_columns.push_back( l_byte );
+    }
+  }
+  return l_columns;
+}
+
+
+/*
+ * pack_glyph; run length packs a glyph's columns (see pal-ssd1306-font.h).
+ *             Runs of three or more of the same byte are always worth it;
+ *             runs of two only if they don't break up a literal run.
+ */
+
+static std::vector<uint8_t> pack_glyph( const std::vector<uint8_t> &p_columns )
+{
+  std::vector<uint8_t> l_packed;
+  size_t               l_literal = 0, l_index = 0, l_run;
+
+  while ( l_index < p_columns.size() )
+  {
+    for ( l_run = 1; l_index + l_run < p_columns.size() && l_run < 129 &&
+                     p_columns[l_index + l_run] == p_columns[l_index]; l_run++ );
+
+    if ( l_run >= 3 || ( l_run == 2 && l_literal == 0 ) )
+    {
+      l_packed.push_back( 0x80 | ( l_run - 2 ) );
+      l_packed.push_back( p_columns[l_index] );
+      l_index += l_run;
+      l_literal = 0;
+      continue;
+    }
+
+    /* Otherwise, it joins (or starts) a literal run. */
+    if ( l_literal == 0 || l_literal == 128 )
+    {
+      l_literal = 0;
+      l_packed.push_back( 0x00 );
+    }
+    l_packed[l_packed.size() - l_literal - 1] = l_literal;
+    l_packed.push_back( p_columns[l_index++] );
+    l_literal++;
+  }
+  return l_packed;
+}
+
+
+/*
+ * glyph_label; names a codepoint, for the comments in the header.
+ */
+
+static std::string glyph_label( int p_code )
+{
+  char l_label[8];
+
+  if ( p_code == 0x20 )
+  {
+    return "space";
+  }
+  if ( p_code == 0x5C )
+  {
+    return "backslash";
+  }
+  if ( p_code > 0x20 && p_code < 0x7F )
+  {
+    return std::string( 1, (char)p_code );
+  }
+  snprintf( l_label, sizeof( l_label ), "0x%02X", p_code );
+  return l_label;
+}
+
+
+/*
+ * usage; explains how to use the tool.
+ */
+
+static int usage( const char *p_name )
+{
+  fprintf( stderr, "Usage: %s [-n name] [-o header.h] [-r first-last] [-c chars] [-f fallback] [-p] [-z] font.bdf|font.psf\n", p_name );
+  return EXIT_FAILURE;
+}
+
+
+/*
+ * main; reads the font, and writes out the header.
+ */
+
+int main( int argc, char **argv )
+{
+  std::string           l_name, l_output_name, l_source, l_guard;
+  const char           *l_output = nullptr;
+  const char           *l_chars = nullptr;
+  unsigned long         l_first = 0x20, l_last = 0x7E;
+  long                  l_fallback = -1;
+  bool                  l_proportional = false, l_rle = false, l_fixed;
+  std::vector<uint8_t>  l_data;
+  static fontc_font_t   l_font;
+  bool                  l_included[FONTC_CODEPOINTS];
+  int                   l_low = -1, l_high = -1;
+  int                   l_opt;
+
+  while ( ( l_opt = getopt( argc, argv, "n:o:r:c:f:pz" ) ) != -1 )
+  {
+    switch( l_opt )
+    {
+      case 'n':
+        l_name = optarg;
+        break;
+      case 'o':
+        l_output = optarg;
+        break;
+      case 'r':
+        {
+          char *l_end;
+
+          l_first = strtoul( optarg, &l_end, 0 );
+          if ( *l_end != '-' )
+          {
+            return usage( argv[0] );
+          }
+          l_last = strtoul( l_end + 1, &l_end, 0 );
+          if ( *l_end != '\0' || l_first > l_last || l_last >= FONTC_CODEPOINTS )
+          {
+            return usage( argv[0] );
+          }
+        }
+        break;
+      case 'c':
+        l_chars = optarg;
+        break;
+      case 'f':
+        l_fallback = strtol( optarg, nullptr, 0 );
+        break;
+      case 'p':
+        l_proportional = true;
+        break;
+      case 'z':
+        l_rle = true;
+        break;
+      default:
+        return usage( argv[0] );
+    }
+  }
+  if ( optind != argc - 1 )
+  {
+    return usage( argv[0] );
+  }
+
+  /* Read the font; PSF fonts announce themselves, anything else is BDF. */
+  if ( !read_file( argv[optind], &l_data ) )
+  {
+    return EXIT_FAILURE;
+  }
+  if ( ( l_data.size() >= 2 && l_data[0] == 0x36 && l_data[1] == 0x04 ) ||
+       ( l_data.size() >= 4 && l_data[0] == 0x72 && l_data[1] == 0xB5 && l_data[2] == 0x4A && l_data[3] == 0x86 ) )
+  {
+    if ( !parse_psf( l_data, &l_font ) )
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  else if ( l_data.size() < 9 || memcmp( l_data.data(), "STARTFONT", 9 ) != 0 || !parse_bdf( l_data, &l_font ) )
+  {
+    fprintf( stderr, "%s is not a BDF or PSF font this tool understands\n", argv[optind] );
+    return EXIT_FAILURE;
+  }
+
+  /* Name things after the font's file, unless told otherwise. */
+  l_source = argv[optind];
+  l_source = l_source.substr( l_source.find_last_of( '/' ) + 1 );
+  if ( l_name.empty() )
+  {
+    l_name = "font_" + l_source.substr( 0, l_source.find( '.' ) );
+  }
+  for ( char &l_char : l_name )
+  {
+    l_char = isalnum( (unsigned char)l_char ) ? l_char : '_';
+  }
+  if ( isdigit( (unsigned char)l_name[0] ) )
+  {
+    l_name = "font_" + l_name;
+  }
+  std::string l_short = ( l_name.compare( 0, 5, "font_" ) == 0 ) ? l_name.substr( 5 ) : l_name;
+  if ( l_output != nullptr )
+  {
+    l_output_name = l_output;
+    l_output_name = l_output_name.substr( l_output_name.find_last_of( '/' ) + 1 );
+  }
+  else
+  {
+    l_output_name = "pal-ssd1306-font-" + l_short + ".h";
+    for ( char &l_char : l_output_name )
+    {
+      l_char = ( l_char == '_' ) ? '-' : l_char;
+    }
+  }
+  l_guard = "PAL_SSD1306_FONT_" + l_short + "_H";
+  for ( char &l_char : l_guard )
+  {
+    l_char = toupper( (unsigned char)l_char );
+  }
+
+  /* Pick out the glyphs we want. */
+  for ( int l_code = 0; l_code < FONTC_CODEPOINTS; l_code++ )
+  {
+    l_included[l_code] = l_font.glyphs[l_code].present && (unsigned long)l_code >= l_first && (unsigned long)l_code <= l_last &&
+                         ( l_chars == nullptr || strchr( l_chars, l_code ) != nullptr ) && l_code != 0;
+    if ( l_included[l_code] )
+    {
+      l_low = ( l_low < 0 ) ? l_code : l_low;
+      l_high = l_code;
+      if ( l_proportional )
+      {
+        trim_glyph( &l_font, &l_font.glyphs[l_code] );
+      }
+    }
+  }
+  if ( l_low < 0 )
+  {
+    fprintf( stderr, "There are no glyphs in %s to include\n", argv[optind] );
+    return EXIT_FAILURE;
+  }
+  if ( l_fallback < 0 )
+  {
+    l_fallback = l_included[0x7F] ? 0x7F : l_included['?'] ? '?' : l_low;
+  }
+  if ( l_fallback < l_low || l_fallback > l_high || !l_included[l_fallback] )
+  {
+    fprintf( stderr, "The fallback, 0x%02lX, is not one of the glyphs included\n", (unsigned long)l_fallback );
+    return EXIT_FAILURE;
+  }
+
+  /* A font can only be fixed width if every glyph is there, and the same. */
+  l_fixed = !l_proportional && !l_rle && l_font.glyphs[l_low].width > 0;
+  for ( int l_code = l_low; l_code <= l_high && l_fixed; l_code++ )
+  {
+    l_fixed = l_included[l_code] && l_font.glyphs[l_code].width == l_font.glyphs[l_low].width &&
+              l_font.glyphs[l_code].advance == l_font.glyphs[l_low].advance;
+  }
+
+  /* Lay out (and maybe pack) the glyphs. */
+  std::vector<std::vector<uint8_t>> l_bitmaps;
+  std::vector<size_t>               l_offsets;
+  size_t                            l_total = 0, l_unpacked = 0;
+
+  for ( int l_code = l_low; l_code <= l_high; l_code++ )
+  {
+    std::vector<uint8_t> l_columns;
+
+    if ( l_included[l_code] )
+    {
+      if ( l_font.glyphs[l_code].width > 255 || l_font.glyphs[l_code].advance > 255 )
+      {
+        fprintf( stderr, "Glyph %s is too wide\n", glyph_label( l_code ).c_str() );
+        return EXIT_FAILURE;
+      }
+      l_columns = glyph_columns( &l_font, &l_font.glyphs[l_code] );
+      l_unpacked += l_columns.size();
+      if ( l_rle )
+      {
+        if ( l_columns.size() > SSD1306_FONT_MAX_UNPACKED )
+        {
+          fprintf( stderr, "Glyph %s is too large to pack\n", glyph_label( l_code ).c_str() );
+          return EXIT_FAILURE;
+        }
+        l_columns = pack_glyph( l_columns );
+      }
+    }
+    l_offsets.push_back( l_total );
+    l_total += l_columns.size();
+    l_bitmaps.push_back( l_columns );
+  }
+  if ( l_total > 0xFFFF )
+  {
+    fprintf( stderr, "The font is too large; try fewer glyphs\n" );
+    return EXIT_FAILURE;
+  }
+
+  /* And write it all out. */
+  FILE *l_file = ( l_output != nullptr ) ? fopen( l_output, "w" ) : stdout;
+  if ( l_file == nullptr )
+  {
+    fprintf( stderr, "Unable to write %s\n", l_output );
+    return EXIT_FAILURE;
+  }
+
+  fprintf( l_file, "/*\n * %s - part of Pico PAL.\n *\n", l_output_name.c_str() );
+  fprintf( l_file, " * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>\n" );
+  fprintf( l_file, " * This file is released under the MIT License; see LICENSE for details.\n *\n" );
+  fprintf( l_file, " * Generated by pal-ssd1306-fontc from %s; %d pixels tall, codepoints\n", l_source.c_str(), l_font.height );
+  fprintf( l_file, " * 0x%02X to 0x%02X%s%s.\n */\n\n", l_low, l_high,
+           l_proportional ? ", proportional" : "", l_rle ? ", run length packed" : "" );
+  fprintf( l_file, "#ifndef   %s\n#define   %s\n\n", l_guard.c_str(), l_guard.c_str() );
+  fprintf( l_file, "#include \"pal-ssd1306-font.h\"\n\nnamespace pal\n{\n" );
+
+  fprintf( l_file, "  inline constexpr uint8_t %s_bitmap[] = {\n", l_name.c_str() );
+  for ( int l_code = l_low; l_code <= l_high; l_code++ )
+  {
+    const std::vector<uint8_t> &l_bytes = l_bitmaps[l_code - l_low];
+
+    fprintf( l_file, "    " );
+    for ( size_t l_index = 0; l_index < l_bytes.size(); l_index++ )
+    {
+      bool l_last_byte = ( l_index == l_bytes.size() - 1 ) && ( l_offsets[l_code - l_low] + l_bytes.size() == l_total );
+
+      fprintf( l_file, "0x%02X%s", l_bytes[l_index], l_last_byte ? "  " : ", " );
+    }
+    fprintf( l_file, "// %s\n", glyph_label( l_code ).c_str() );
+  }
+  fprintf( l_file, "  };\n\n" );
+
+  if ( l_fixed )
+  {
+    fprintf( l_file, "  inline constexpr Font %s = { %d, 0x%02X, 0x%02X, 0x%02lX, %d, %d, nullptr, %s_bitmap, 0 };\n",
+             l_name.c_str(), l_font.height, l_low, l_high, (unsigned long)l_fallback,
+             l_font.glyphs[l_low].width, l_font.glyphs[l_low].advance, l_name.c_str() );
+  }
+  else
+  {
+    fprintf( l_file, "  inline constexpr ssd1306_glyph_t %s_glyphs[] = {\n", l_name.c_str() );
+    for ( int l_code = l_low; l_code <= l_high; l_code++ )
+    {
+      fprintf( l_file, "    { %4zu, %d, %d }%s // %s\n", l_offsets[l_code - l_low],
+               l_included[l_code] ? l_font.glyphs[l_code].width : 0, l_included[l_code] ? l_font.glyphs[l_code].advance : 0,
+               ( l_code < l_high ) ? "," : " ", glyph_label( l_code ).c_str() );
+    }
+    fprintf( l_file, "  };\n\n" );
+    fprintf( l_file, "  inline constexpr Font %s = { %d, 0x%02X, 0x%02X, 0x%02lX, 0, 0, %s_glyphs, %s_bitmap, %s };\n",
+             l_name.c_str(), l_font.height, l_low, l_high, (unsigned long)l_fallback,
+             l_name.c_str(), l_name.c_str(), l_rle ? "SSD1306_FONT_RLE" : "0" );
+  }
+  fprintf( l_file, "}\n\n#endif /* %s */\n\n/* End of file %s */\n", l_guard.c_str(), l_output_name.c_str() );
+
+  if ( l_output != nullptr )
+  {
+    fclose( l_file );
+  }
+
+  fprintf( stderr, "%s: %d glyphs, %d pixels tall; %zu bytes of bitmap", l_name.c_str(), l_high - l_low + 1, l_font.height, l_total );
+  if ( l_rle )
+  {
+    fprintf( stderr, " (%zu unpacked)", l_unpacked );
+  }
+  fprintf( stderr, "\n" );
+  if ( l_rle && l_total >= l_unpacked )
+  {
+    fprintf( stderr, "Warning: packing doesn't make this font any smaller; it's better left unpacked\n" );
+  }
+  return EXIT_SUCCESS;
+}
+
+
+/* End of file pal-ssd1306-fontc.cpp */
@@ -0,0 +1,313 @@
+/*
+ * pal-ssd1306-replay.cpp - part of Pico PAL.
+ *
+ * Copyright (c) 2021 Pete Favelle <pico@fsquared.co.uk>
+ * This file is released under the MIT License; see LICENSE for details.
+ *
+ * Replays a trace recorded by RecordingTransport into the simulated
+ * controller, and optionally onto a real display through /dev/i2c-N, then
+ * reports on it: what was sent, how long it would take on the bus, and how
+ * much of it changed nothing on the display.
+ *
+ *   pal-ssd1306-replay [options] <trace>
+ *     -s WxH        size of the panel (default 128x64)
+ *     -o FILE       save what the panel ends up showing, as a PBM image
+ *     -c HZ         I2C clock to predict bus time at (default 400000)
+ *     -d DEVICE     also replay onto the display on this I2C bus (Linux)
+ *     -a ADDRESS    the display's I2C address (default 0x3C)
+ *     -r            replay onto the display in real time, as recorded
+ */
+
+/* Header files. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pal-ssd1306-sim.h"
+#include "pal-ssd1306-timing.h"
+#include "pal-ssd1306-trace.h"
+#ifdef __linux__
+#include "pal-ssd1306-linux.h"
+#endif
+
+
+/* Types. */
+
+typedef struct
+{
+  uint8_t   flags;
+  uint64_t  delta_us;
+  uint8_t  *payload;
+  size_t    length;
+} replay_record_t;
+
+
+/* Functions. */
+
+/*
+ * read_varint; reads a varint from the trace, returning false if it runs off
+ *              the end.
+ */
+
+static bool read_varint( const uint8_t *p_trace, size_t p_size, size_t *p_offset, uint64_t *p_value )
+{
+  uint8_t l_shift = 0;
+
+  *p_value = 0;
+  while ( *p_offset < p_size && l_shift < 64 )
+  {
+    *p_value |= (uint64_t)( p_trace[*p_offset] & 0x7F ) << l_shift;
+    if ( ( p_trace[( *p_offset )++] & 0x80 ) == 0 )
+    {
+      return true;
+    }
+    l_shift += 7;
+  }
+  return false;
+}
+
+
+/*
+ * read_record; reads the next record from the trace. The payload is left
+ *              where it is; the byte in front of it is always part of the
+ *              record's header, so transports are free to borrow it.
+ */
+
+static bool read_record( uint8_t *p_trace, size_t p_size, size_t *p_offset, replay_record_t *p_record )
+{
+  uint64_t l_length;
+
+  if ( *p_offset >= p_size )
+  {
+    return false;
+  }
+  p_record->flags = p_trace[( *p_offset )++];
+  if ( !read_varint( p_trace, p_size, p_offset, &p_record->delta_us ) ||
+       !read_varint( p_trace, p_size, p_offset, &l_length ) ||
+       l_length > p_size - *p_offset )
+  {
+    return false;
+  }
+  p_record->payload = p_trace + *p_offset;
+  p_record->length = l_length;
+  *p_offset += l_length;
+  return true;
+}
+
+
+/*
+ * load_trace; reads a whole trace file into memory, checking its header.
+ */
+
+static uint8_t *load_trace( const char *p_filename, size_t *p_size )
+{
+  FILE    *l_file;
+  uint8_t *l_trace;
+  long     l_size;
+
+  l_file = fopen( p_filename, "rb" );
+  if ( l_file == nullptr )
+  {
+    fprintf( stderr, "Unable to open %s\n", p_filename );
+    return nullptr;
+  }
+  fseek( l_file, 0, SEEK_END );
+  l_size = ftell( l_file );
+  fseek( l_file, 0, SEEK_SET );
+
+  l_trace = ( l_size > 0 ) ? (uint8_t *)malloc( l_size ) : nullptr;
+  if ( l_trace == nullptr || fread( l_trace, 1, l_size, l_file ) != (size_t)l_size )
+  {
+    fprintf( stderr, "Unable to read %s\n", p_filename );
+    fclose( l_file );
+    free( l_trace );
+    return nullptr;
+  }
+  fclose( l_file );
+
+  if ( l_size < 5 || memcmp( l_trace, "SSDT", 4 ) != 0 || l_trace[4] != SSD1306_TRACE_VERSION )
+  {
+    fprintf( stderr, "%s is not an SSD1306 trace this tool understands\n", p_filename );
+    free( l_trace );
+    return nullptr;
+  }
+
+  *p_size = l_size;
+  return l_trace;
+}
+
+
+/*
+ * usage; explains how to use the tool.
+ */
+
+static int usage( const char *p_name )
+{
+  fprintf( stderr, "Usage: %s [-s WxH] [-o image.pbm] [-c clock] [-d /dev/i2c-N [-a address] [-r]] trace\n", p_name );
+  return EXIT_FAILURE;
+}
+
+
+/*
+ * main; replays the trace, and reports on it.
+ */
+
+int main( int argc, char **argv )
+{
+  const char           *l_image = nullptr;
+  const char           *l_device = nullptr;
+  unsigned int          l_width = 128, l_height = 64;
+  unsigned long         l_clock = 400000;
+  unsigned long         l_address = 0x3C;
+  bool                  l_realtime = false;
+  uint8_t              *l_trace;
+  size_t                l_size, l_offset;
+  replay_record_t       l_record;
+  size_t                l_records = 0, l_failed = 0, l_display_failed = 0;
+  uint64_t              l_span_us = 0;
+  int                   l_opt;
+
+  while ( ( l_opt = getopt( argc, argv, "s:o:c:d:a:r" ) ) != -1 )
+  {
+    switch( l_opt )
+    {
+      case 's':
+        if ( sscanf( optarg, "%ux%u", &l_width, &l_height ) != 2 ||
+             l_width == 0 || l_width > 128 || l_height == 0 || l_height > 64 )
+        {
+          return usage( argv[0] );
+        }
+        break;
+      case 'o':
+        l_image = optarg;
+        break;
+      case 'c':
+        l_clock = strtoul( optarg, nullptr, 0 );
+        break;
+      case 'd':
+        l_device = optarg;
+        break;
+      case 'a':
+        l_address = strtoul( optarg, nullptr, 0 );
+        break;
+      case 'r':
+        l_realtime = true;
+        break;
+      default:
+        return usage( argv[0] );
+    }
+  }
+  if ( optind != argc - 1 )
+  {
+    return usage( argv[0] );
+  }
+
+  l_trace = load_trace( argv[optind], &l_size );
+  if ( l_trace == nullptr )
+  {
+    return EXIT_FAILURE;
+  }
+
+  pal::SimulatorTransport l_sim( l_width, l_height );
+  pal::I2CTimingModel     l_model( l_clock );
+
+#ifdef __linux__
+  pal::LinuxI2CTransport  l_display( l_device, l_address );
+  if ( l_device != nullptr )
+  {
+    l_display.begin();
+  }
+#else
+  if ( l_device != nullptr )
+  {
+    fprintf( stderr, "Replaying onto a display is only supported on Linux\n" );
+    free( l_trace );
+    return EXIT_FAILURE;
+  }
+#endif
+
+  /* Work through the trace, record by record. */
+  l_offset = 5;
+  while ( read_record( l_trace, l_size, &l_offset, &l_record ) )
+  {
+    l_records++;
+    l_span_us += l_record.delta_us;
+    l_failed += ( l_record.flags & SSD1306_TRACE_FAILED ) ? 1 : 0;
+    l_model.add( ( l_record.flags & SSD1306_TRACE_HOLD ) != 0, l_record.length );
+
+    if ( l_record.flags & SSD1306_TRACE_DATA )
+    {
+      l_sim.write_data( l_record.payload, l_record.length );
+    }
+    else
+    {
+      l_sim.write_commands( l_record.payload, l_record.length, ( l_record.flags & SSD1306_TRACE_HOLD ) != 0 );
+    }
+
+#ifdef __linux__
+    if ( l_device != nullptr )
+    {
+      bool l_sent;
+
+      if ( l_realtime && l_record.delta_us > 0 )
+      {
+        usleep( l_record.delta_us );
+      }
+      if ( l_record.flags & SSD1306_TRACE_DATA )
+      {
+        l_sent = l_display.write_data( l_record.payload, l_record.length );
+      }
+      else
+      {
+        l_sent = l_display.write_commands( l_record.payload, l_record.length, ( l_record.flags & SSD1306_TRACE_HOLD ) != 0 );
+      }
+      l_display_failed += l_sent ? 0 : 1;
+    }
+#endif
+  }
+  if ( l_offset != l_size )
+  {
+    fprintf( stderr, "Warning: trace is truncated or damaged at offset %zu\n", l_offset );
+  }
+
+  /* Report on what we found. */
+  const pal::ssd1306_sim_counts_t *l_counts = l_sim.counts();
+  const pal::ssd1306_bus_timing_t *l_timing = l_model.timing();
+
+  printf( "records:            %zu (%zu recorded as failed), over %.3f s\n",
+          l_records, l_failed, l_span_us / 1.0e6 );
+  printf( "command bytes:      %zu, of which %zu changed nothing\n",
+          l_counts->command_bytes, l_counts->redundant_command_bytes );
+  printf( "data bytes:         %zu, of which %zu were already on the display\n",
+          l_counts->data_bytes, l_counts->unchanged_data_bytes );
+  printf( "data writes:        %zu, of which %zu changed nothing\n",
+          l_counts->data_writes, l_counts->unchanged_data_writes );
+  printf( "page writes:        %zu, of which %zu changed nothing\n",
+          l_counts->page_writes, l_counts->unchanged_page_writes );
+  printf( "bus time @ %lu Hz: %.3f ms for %zu bytes on the wire",
+          l_clock, l_timing->duration_ns / 1.0e6, l_timing->wire_bytes );
+  if ( l_span_us > 0 )
+  {
+    printf( ", %.1f%% of the time recorded", l_model.utilisation( 1.0e6f / l_span_us ) * 100.0f );
+  }
+  printf( "\n" );
+  if ( l_device != nullptr )
+  {
+    printf( "replayed onto %s, with %zu writes failing\n", l_device, l_display_failed );
+  }
+
+  if ( l_image != nullptr && !l_sim.write_pbm( l_image ) )
+  {
+    fprintf( stderr, "Unable to write %s\n", l_image );
+    free( l_trace );
+    return EXIT_FAILURE;
+  }
+
+  free( l_trace );
+  return EXIT_SUCCESS;
+}
+
+
+/* End of file pal-ssd1306-replay.cpp */